@@ -0,0 +1,510 @@
+#include "aesbackend.h"
+#include <array>
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define AES_X86 1
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define AESNI_TARGET
+#else
+#include <cpuid.h>
+// 🔹 Лише ці функції компілюються з AES-NI, решта програми запускається на будь-якому x86
+#define AESNI_TARGET __attribute__((target("aes,sse2")))
+#endif
+#endif
+
+namespace {
+
+constexpr quint8 sbox[256] = {
+  //0     1    2      3     4    5     6     7      8    9     A      B    C     D     E     F
+  0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+  0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+  0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+  0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+  0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+  0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+  0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+  0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+  0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+  0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+  0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+  0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+  0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+  0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+  0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+  0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16 };
+
+constexpr quint8 rsbox[256] = {
+  0x52, 0x09, 0x6a, 0xd5, 0x30, 0x36, 0xa5, 0x38, 0xbf, 0x40, 0xa3, 0x9e, 0x81, 0xf3, 0xd7, 0xfb,
+  0x7c, 0xe3, 0x39, 0x82, 0x9b, 0x2f, 0xff, 0x87, 0x34, 0x8e, 0x43, 0x44, 0xc4, 0xde, 0xe9, 0xcb,
+  0x54, 0x7b, 0x94, 0x32, 0xa6, 0xc2, 0x23, 0x3d, 0xee, 0x4c, 0x95, 0x0b, 0x42, 0xfa, 0xc3, 0x4e,
+  0x08, 0x2e, 0xa1, 0x66, 0x28, 0xd9, 0x24, 0xb2, 0x76, 0x5b, 0xa2, 0x49, 0x6d, 0x8b, 0xd1, 0x25,
+  0x72, 0xf8, 0xf6, 0x64, 0x86, 0x68, 0x98, 0x16, 0xd4, 0xa4, 0x5c, 0xcc, 0x5d, 0x65, 0xb6, 0x92,
+  0x6c, 0x70, 0x48, 0x50, 0xfd, 0xed, 0xb9, 0xda, 0x5e, 0x15, 0x46, 0x57, 0xa7, 0x8d, 0x9d, 0x84,
+  0x90, 0xd8, 0xab, 0x00, 0x8c, 0xbc, 0xd3, 0x0a, 0xf7, 0xe4, 0x58, 0x05, 0xb8, 0xb3, 0x45, 0x06,
+  0xd0, 0x2c, 0x1e, 0x8f, 0xca, 0x3f, 0x0f, 0x02, 0xc1, 0xaf, 0xbd, 0x03, 0x01, 0x13, 0x8a, 0x6b,
+  0x3a, 0x91, 0x11, 0x41, 0x4f, 0x67, 0xdc, 0xea, 0x97, 0xf2, 0xcf, 0xce, 0xf0, 0xb4, 0xe6, 0x73,
+  0x96, 0xac, 0x74, 0x22, 0xe7, 0xad, 0x35, 0x85, 0xe2, 0xf9, 0x37, 0xe8, 0x1c, 0x75, 0xdf, 0x6e,
+  0x47, 0xf1, 0x1a, 0x71, 0x1d, 0x29, 0xc5, 0x89, 0x6f, 0xb7, 0x62, 0x0e, 0xaa, 0x18, 0xbe, 0x1b,
+  0xfc, 0x56, 0x3e, 0x4b, 0xc6, 0xd2, 0x79, 0x20, 0x9a, 0xdb, 0xc0, 0xfe, 0x78, 0xcd, 0x5a, 0xf4,
+  0x1f, 0xdd, 0xa8, 0x33, 0x88, 0x07, 0xc7, 0x31, 0xb1, 0x12, 0x10, 0x59, 0x27, 0x80, 0xec, 0x5f,
+  0x60, 0x51, 0x7f, 0xa9, 0x19, 0xb5, 0x4a, 0x0d, 0x2d, 0xe5, 0x7a, 0x9f, 0x93, 0xc9, 0x9c, 0xef,
+  0xa0, 0xe0, 0x3b, 0x4d, 0xae, 0x2a, 0xf5, 0xb0, 0xc8, 0xeb, 0xbb, 0x3c, 0x83, 0x53, 0x99, 0x61,
+  0x17, 0x2b, 0x04, 0x7e, 0xba, 0x77, 0xd6, 0x26, 0xe1, 0x69, 0x14, 0x63, 0x55, 0x21, 0x0c, 0x7d };
+
+constexpr quint8 xTime(quint8 x) {
+    return quint8((x << 1) ^ ((x >> 7) * 0x1b));
+}
+
+constexpr quint8 multiply(quint8 x, quint8 y) {
+    quint8 result = 0;
+    while (y) {
+        if (y & 1) {
+            result ^= x;
+        }
+        x = xTime(x);
+        y >>= 1;
+    }
+    return result;
+}
+
+constexpr quint32 rotr8(quint32 w) {
+    return (w >> 8) | (w << 24);
+}
+
+using Table = std::array<quint32, 256>;
+
+// 🔹 Te[n][x] — SubBytes + MixColumns для байта x у рядку n; Td — те саме для розшифрування
+constexpr std::array<Table, 4> makeEncryptTables() {
+    std::array<Table, 4> t{};
+    for (int x = 0; x < 256; ++x) {
+        const quint8 s = sbox[x];
+        quint32 w = (quint32(multiply(s, 2)) << 24) | (quint32(s) << 16) | (quint32(s) << 8) | multiply(s, 3);
+        for (int n = 0; n < 4; ++n) {
+            t[n][x] = w;
+            w = rotr8(w);
+        }
+    }
+    return t;
+}
+
+constexpr std::array<Table, 4> makeDecryptTables() {
+    std::array<Table, 4> t{};
+    for (int x = 0; x < 256; ++x) {
+        const quint8 s = rsbox[x];
+        quint32 w = (quint32(multiply(s, 0x0e)) << 24) | (quint32(multiply(s, 0x09)) << 16)
+                    | (quint32(multiply(s, 0x0d)) << 8) | multiply(s, 0x0b);
+        for (int n = 0; n < 4; ++n) {
+            t[n][x] = w;
+            w = rotr8(w);
+        }
+    }
+    return t;
+}
+
+constexpr std::array<Table, 4> Te = makeEncryptTables();
+constexpr std::array<Table, 4> Td = makeDecryptTables();
+
+inline quint32 load32(const quint8 *p) {
+    return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]);
+}
+
+inline void store32(quint8 *p, quint32 w) {
+    p[0] = quint8(w >> 24);
+    p[1] = quint8(w >> 16);
+    p[2] = quint8(w >> 8);
+    p[3] = quint8(w);
+}
+
+inline quint32 lastRound(const quint8 *box, quint32 a, quint32 b, quint32 c, quint32 d) {
+    return (quint32(box[a >> 24]) << 24) | (quint32(box[(b >> 16) & 0xff]) << 16)
+           | (quint32(box[(c >> 8) & 0xff]) << 8) | quint32(box[d & 0xff]);
+}
+
+void portableEncryptBlock(const quint8 *rk, int rounds, const quint8 *in, quint8 *out) {
+    quint32 s0 = load32(in) ^ load32(rk);
+    quint32 s1 = load32(in + 4) ^ load32(rk + 4);
+    quint32 s2 = load32(in + 8) ^ load32(rk + 8);
+    quint32 s3 = load32(in + 12) ^ load32(rk + 12);
+
+    for (int round = 1; round < rounds; ++round) {
+        rk += 16;
+        const quint32 t0 = Te[0][s0 >> 24] ^ Te[1][(s1 >> 16) & 0xff] ^ Te[2][(s2 >> 8) & 0xff] ^ Te[3][s3 & 0xff] ^ load32(rk);
+        const quint32 t1 = Te[0][s1 >> 24] ^ Te[1][(s2 >> 16) & 0xff] ^ Te[2][(s3 >> 8) & 0xff] ^ Te[3][s0 & 0xff] ^ load32(rk + 4);
+        const quint32 t2 = Te[0][s2 >> 24] ^ Te[1][(s3 >> 16) & 0xff] ^ Te[2][(s0 >> 8) & 0xff] ^ Te[3][s1 & 0xff] ^ load32(rk + 8);
+        const quint32 t3 = Te[0][s3 >> 24] ^ Te[1][(s0 >> 16) & 0xff] ^ Te[2][(s1 >> 8) & 0xff] ^ Te[3][s2 & 0xff] ^ load32(rk + 12);
+        s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+    }
+
+    rk += 16;
+    store32(out, lastRound(sbox, s0, s1, s2, s3) ^ load32(rk));
+    store32(out + 4, lastRound(sbox, s1, s2, s3, s0) ^ load32(rk + 4));
+    store32(out + 8, lastRound(sbox, s2, s3, s0, s1) ^ load32(rk + 8));
+    store32(out + 12, lastRound(sbox, s3, s0, s1, s2) ^ load32(rk + 12));
+}
+
+void portableDecryptBlock(const quint8 *rk, int rounds, const quint8 *in, quint8 *out) {
+    quint32 s0 = load32(in) ^ load32(rk);
+    quint32 s1 = load32(in + 4) ^ load32(rk + 4);
+    quint32 s2 = load32(in + 8) ^ load32(rk + 8);
+    quint32 s3 = load32(in + 12) ^ load32(rk + 12);
+
+    for (int round = 1; round < rounds; ++round) {
+        rk += 16;
+        const quint32 t0 = Td[0][s0 >> 24] ^ Td[1][(s3 >> 16) & 0xff] ^ Td[2][(s2 >> 8) & 0xff] ^ Td[3][s1 & 0xff] ^ load32(rk);
+        const quint32 t1 = Td[0][s1 >> 24] ^ Td[1][(s0 >> 16) & 0xff] ^ Td[2][(s3 >> 8) & 0xff] ^ Td[3][s2 & 0xff] ^ load32(rk + 4);
+        const quint32 t2 = Td[0][s2 >> 24] ^ Td[1][(s1 >> 16) & 0xff] ^ Td[2][(s0 >> 8) & 0xff] ^ Td[3][s3 & 0xff] ^ load32(rk + 8);
+        const quint32 t3 = Td[0][s3 >> 24] ^ Td[1][(s2 >> 16) & 0xff] ^ Td[2][(s1 >> 8) & 0xff] ^ Td[3][s0 & 0xff] ^ load32(rk + 12);
+        s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+    }
+
+    rk += 16;
+    store32(out, lastRound(rsbox, s0, s3, s2, s1) ^ load32(rk));
+    store32(out + 4, lastRound(rsbox, s1, s0, s3, s2) ^ load32(rk + 4));
+    store32(out + 8, lastRound(rsbox, s2, s1, s0, s3) ^ load32(rk + 8));
+    store32(out + 12, lastRound(rsbox, s3, s2, s1, s0) ^ load32(rk + 12));
+}
+
+inline void xorBlock(quint8 *dst, const quint8 *a, const quint8 *b) {
+    for (int i = 0; i < AesBackend::BlockSize; ++i) {
+        dst[i] = a[i] ^ b[i];
+    }
+}
+
+void portableEncryptEcb(const quint8 *schedule, int rounds, const quint8 *in, quint8 *out, qsizetype blocks) {
+    for (qsizetype i = 0; i < blocks; ++i, in += 16, out += 16) {
+        portableEncryptBlock(schedule, rounds, in, out);
+    }
+}
+
+void portableDecryptEcb(const quint8 *schedule, int rounds, const quint8 *in, quint8 *out, qsizetype blocks) {
+    for (qsizetype i = 0; i < blocks; ++i, in += 16, out += 16) {
+        portableDecryptBlock(schedule, rounds, in, out);
+    }
+}
+
+void portableEncryptCbc(const quint8 *schedule, int rounds, quint8 *iv, const quint8 *in, quint8 *out, qsizetype blocks) {
+    quint8 block[16];
+    for (qsizetype i = 0; i < blocks; ++i, in += 16, out += 16) {
+        xorBlock(block, in, iv);
+        portableEncryptBlock(schedule, rounds, block, out);
+        std::memcpy(iv, out, 16);
+    }
+}
+
+void portableDecryptCbc(const quint8 *schedule, int rounds, quint8 *iv, const quint8 *in, quint8 *out, qsizetype blocks) {
+    quint8 cipherBlock[16];
+    quint8 plain[16];
+    for (qsizetype i = 0; i < blocks; ++i, in += 16, out += 16) {
+        std::memcpy(cipherBlock, in, 16);  // 🔹 in і out можуть збігатися
+        portableDecryptBlock(schedule, rounds, cipherBlock, plain);
+        xorBlock(out, plain, iv);
+        std::memcpy(iv, cipherBlock, 16);
+    }
+}
+
+#ifdef AES_X86
+
+bool cpuHasAesNi() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4] = {};
+    __cpuid(info, 1);
+    const unsigned ecx = unsigned(info[2]);
+    const unsigned edx = unsigned(info[3]);
+#else
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+#endif
+    return (ecx & (1u << 25)) && (edx & (1u << 26));  // AES та SSE2
+}
+
+AESNI_TARGET inline void loadSchedule(__m128i *keys, const quint8 *schedule, int rounds) {
+    for (int r = 0; r <= rounds; ++r) {
+        keys[r] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(schedule + 16 * r));
+    }
+}
+
+AESNI_TARGET inline __m128i niEncryptBlock(__m128i block, const __m128i *keys, int rounds) {
+    block = _mm_xor_si128(block, keys[0]);
+    for (int r = 1; r < rounds; ++r) {
+        block = _mm_aesenc_si128(block, keys[r]);
+    }
+    return _mm_aesenclast_si128(block, keys[rounds]);
+}
+
+AESNI_TARGET inline __m128i niDecryptBlock(__m128i block, const __m128i *keys, int rounds) {
+    block = _mm_xor_si128(block, keys[0]);
+    for (int r = 1; r < rounds; ++r) {
+        block = _mm_aesdec_si128(block, keys[r]);
+    }
+    return _mm_aesdeclast_si128(block, keys[rounds]);
+}
+
+// 🔹 Чотири незалежні блоки за прохід: aesenc/aesdec мають затримку в кілька тактів, і конвеєр не простоює
+AESNI_TARGET void niEncryptEcb(const quint8 *schedule, int rounds, const quint8 *in, quint8 *out, qsizetype blocks) {
+    __m128i keys[15];
+    loadSchedule(keys, schedule, rounds);
+    const __m128i *src = reinterpret_cast<const __m128i *>(in);
+    __m128i *dst = reinterpret_cast<__m128i *>(out);
+
+    qsizetype i = 0;
+    for (; i + 4 <= blocks; i += 4) {
+        __m128i b0 = _mm_xor_si128(_mm_loadu_si128(src + i), keys[0]);
+        __m128i b1 = _mm_xor_si128(_mm_loadu_si128(src + i + 1), keys[0]);
+        __m128i b2 = _mm_xor_si128(_mm_loadu_si128(src + i + 2), keys[0]);
+        __m128i b3 = _mm_xor_si128(_mm_loadu_si128(src + i + 3), keys[0]);
+        for (int r = 1; r < rounds; ++r) {
+            b0 = _mm_aesenc_si128(b0, keys[r]);
+            b1 = _mm_aesenc_si128(b1, keys[r]);
+            b2 = _mm_aesenc_si128(b2, keys[r]);
+            b3 = _mm_aesenc_si128(b3, keys[r]);
+        }
+        _mm_storeu_si128(dst + i, _mm_aesenclast_si128(b0, keys[rounds]));
+        _mm_storeu_si128(dst + i + 1, _mm_aesenclast_si128(b1, keys[rounds]));
+        _mm_storeu_si128(dst + i + 2, _mm_aesenclast_si128(b2, keys[rounds]));
+        _mm_storeu_si128(dst + i + 3, _mm_aesenclast_si128(b3, keys[rounds]));
+    }
+    for (; i < blocks; ++i) {
+        _mm_storeu_si128(dst + i, niEncryptBlock(_mm_loadu_si128(src + i), keys, rounds));
+    }
+}
+
+AESNI_TARGET void niDecryptEcb(const quint8 *schedule, int rounds, const quint8 *in, quint8 *out, qsizetype blocks) {
+    __m128i keys[15];
+    loadSchedule(keys, schedule, rounds);
+    const __m128i *src = reinterpret_cast<const __m128i *>(in);
+    __m128i *dst = reinterpret_cast<__m128i *>(out);
+
+    qsizetype i = 0;
+    for (; i + 4 <= blocks; i += 4) {
+        __m128i b0 = _mm_xor_si128(_mm_loadu_si128(src + i), keys[0]);
+        __m128i b1 = _mm_xor_si128(_mm_loadu_si128(src + i + 1), keys[0]);
+        __m128i b2 = _mm_xor_si128(_mm_loadu_si128(src + i + 2), keys[0]);
+        __m128i b3 = _mm_xor_si128(_mm_loadu_si128(src + i + 3), keys[0]);
+        for (int r = 1; r < rounds; ++r) {
+            b0 = _mm_aesdec_si128(b0, keys[r]);
+            b1 = _mm_aesdec_si128(b1, keys[r]);
+            b2 = _mm_aesdec_si128(b2, keys[r]);
+            b3 = _mm_aesdec_si128(b3, keys[r]);
+        }
+        _mm_storeu_si128(dst + i, _mm_aesdeclast_si128(b0, keys[rounds]));
+        _mm_storeu_si128(dst + i + 1, _mm_aesdeclast_si128(b1, keys[rounds]));
+        _mm_storeu_si128(dst + i + 2, _mm_aesdeclast_si128(b2, keys[rounds]));
+        _mm_storeu_si128(dst + i + 3, _mm_aesdeclast_si128(b3, keys[rounds]));
+    }
+    for (; i < blocks; ++i) {
+        _mm_storeu_si128(dst + i, niDecryptBlock(_mm_loadu_si128(src + i), keys, rounds));
+    }
+}
+
+// 🔹 Шифрування CBC послідовне за своєю природою: кожен блок залежить від попереднього
+AESNI_TARGET void niEncryptCbc(const quint8 *schedule, int rounds, quint8 *iv, const quint8 *in, quint8 *out, qsizetype blocks) {
+    __m128i keys[15];
+    loadSchedule(keys, schedule, rounds);
+    const __m128i *src = reinterpret_cast<const __m128i *>(in);
+    __m128i *dst = reinterpret_cast<__m128i *>(out);
+
+    __m128i chain = _mm_loadu_si128(reinterpret_cast<const __m128i *>(iv));
+    for (qsizetype i = 0; i < blocks; ++i) {
+        chain = niEncryptBlock(_mm_xor_si128(_mm_loadu_si128(src + i), chain), keys, rounds);
+        _mm_storeu_si128(dst + i, chain);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(iv), chain);
+}
+
+AESNI_TARGET void niDecryptCbc(const quint8 *schedule, int rounds, quint8 *iv, const quint8 *in, quint8 *out, qsizetype blocks) {
+    __m128i keys[15];
+    loadSchedule(keys, schedule, rounds);
+    const __m128i *src = reinterpret_cast<const __m128i *>(in);
+    __m128i *dst = reinterpret_cast<__m128i *>(out);
+
+    __m128i chain = _mm_loadu_si128(reinterpret_cast<const __m128i *>(iv));
+    qsizetype i = 0;
+    for (; i + 4 <= blocks; i += 4) {
+        const __m128i c0 = _mm_loadu_si128(src + i);
+        const __m128i c1 = _mm_loadu_si128(src + i + 1);
+        const __m128i c2 = _mm_loadu_si128(src + i + 2);
+        const __m128i c3 = _mm_loadu_si128(src + i + 3);
+        __m128i b0 = _mm_xor_si128(c0, keys[0]);
+        __m128i b1 = _mm_xor_si128(c1, keys[0]);
+        __m128i b2 = _mm_xor_si128(c2, keys[0]);
+        __m128i b3 = _mm_xor_si128(c3, keys[0]);
+        for (int r = 1; r < rounds; ++r) {
+            b0 = _mm_aesdec_si128(b0, keys[r]);
+            b1 = _mm_aesdec_si128(b1, keys[r]);
+            b2 = _mm_aesdec_si128(b2, keys[r]);
+            b3 = _mm_aesdec_si128(b3, keys[r]);
+        }
+        _mm_storeu_si128(dst + i, _mm_xor_si128(_mm_aesdeclast_si128(b0, keys[rounds]), chain));
+        _mm_storeu_si128(dst + i + 1, _mm_xor_si128(_mm_aesdeclast_si128(b1, keys[rounds]), c0));
+        _mm_storeu_si128(dst + i + 2, _mm_xor_si128(_mm_aesdeclast_si128(b2, keys[rounds]), c1));
+        _mm_storeu_si128(dst + i + 3, _mm_xor_si128(_mm_aesdeclast_si128(b3, keys[rounds]), c2));
+        chain = c3;
+    }
+    for (; i < blocks; ++i) {
+        const __m128i c = _mm_loadu_si128(src + i);
+        _mm_storeu_si128(dst + i, _mm_xor_si128(niDecryptBlock(c, keys, rounds), chain));
+        chain = c;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(iv), chain);
+}
+
+#endif // AES_X86
+
+std::atomic<int> activeKind{-1};
+
+} // namespace
+
+bool AesBackend::isSupported(Kind kind) {
+    switch (kind) {
+    case Portable:
+        return true;
+    case AesNi:
+#ifdef AES_X86
+    {
+        static const bool supported = cpuHasAesNi();
+        return supported;
+    }
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+AesBackend::Kind AesBackend::active() {
+    int kind = activeKind.load(std::memory_order_relaxed);
+    if (kind < 0) {
+        kind = isSupported(AesNi) ? AesNi : Portable;
+        activeKind.store(kind, std::memory_order_relaxed);
+    }
+    return Kind(kind);
+}
+
+bool AesBackend::setActive(Kind kind) {
+    if (!isSupported(kind)) {
+        return false;
+    }
+    activeKind.store(kind, std::memory_order_relaxed);
+    return true;
+}
+
+const char *AesBackend::name(Kind kind) {
+    switch (kind) {
+    case Portable: return "portable";
+    case AesNi:    return "aes-ni";
+    }
+    return "unknown";
+}
+
+int AesBackend::rounds(int keyLen) {
+    switch (keyLen) {
+    case 16: return 10;
+    case 24: return 12;
+    case 32: return 14;
+    default: return 0;
+    }
+}
+
+/**
+ * @brief Розгортання ключа за FIPS-197 (5.2); однакове для обох реалізацій
+ *
+ * AES-NI має aeskeygenassist, але ключ розгортається один раз на ключ, тож спільний
+ * байтовий код простіший і гарантує однаковий розклад.
+ */
+void AesBackend::expandEncryptKey(const quint8 *key, int keyLen, quint8 *schedule) {
+    const int nk = keyLen / 4;
+    const int words = 4 * (rounds(keyLen) + 1);
+    std::memcpy(schedule, key, size_t(keyLen));
+
+    quint8 rcon = 0x01;
+    for (int i = nk; i < words; ++i) {
+        quint8 temp[4];
+        std::memcpy(temp, schedule + (i - 1) * 4, 4);
+
+        if (i % nk == 0) {
+            const quint8 first = temp[0];  // RotWord + SubWord + Rcon
+            temp[0] = quint8(sbox[temp[1]] ^ rcon);
+            temp[1] = sbox[temp[2]];
+            temp[2] = sbox[temp[3]];
+            temp[3] = sbox[first];
+            rcon = xTime(rcon);
+        } else if (nk > 6 && i % nk == 4) {
+            for (quint8 &b : temp) {
+                b = sbox[b];
+            }
+        }
+
+        for (int j = 0; j < 4; ++j) {
+            schedule[i * 4 + j] = schedule[(i - nk) * 4 + j] ^ temp[j];
+        }
+    }
+}
+
+/**
+ * @brief Розклад для розшифрування: раундові ключі у зворотному порядку, проміжні — через InvMixColumns
+ *
+ * Так само його будує AES_set_decrypt_key для aesdec; T-таблиці Td розраховані на той самий розклад.
+ */
+void AesBackend::makeDecryptKey(const quint8 *encSchedule, int rounds, quint8 *decSchedule) {
+    std::memcpy(decSchedule, encSchedule + rounds * 16, 16);
+    std::memcpy(decSchedule + rounds * 16, encSchedule, 16);
+
+    for (int r = 1; r < rounds; ++r) {
+        const quint8 *src = encSchedule + (rounds - r) * 16;
+        quint8 *dst = decSchedule + r * 16;
+        for (int c = 0; c < 16; c += 4) {
+            const quint8 a = src[c], b = src[c + 1], d = src[c + 2], e = src[c + 3];
+            dst[c]     = multiply(a, 0x0e) ^ multiply(b, 0x0b) ^ multiply(d, 0x0d) ^ multiply(e, 0x09);
+            dst[c + 1] = multiply(a, 0x09) ^ multiply(b, 0x0e) ^ multiply(d, 0x0b) ^ multiply(e, 0x0d);
+            dst[c + 2] = multiply(a, 0x0d) ^ multiply(b, 0x09) ^ multiply(d, 0x0e) ^ multiply(e, 0x0b);
+            dst[c + 3] = multiply(a, 0x0b) ^ multiply(b, 0x0d) ^ multiply(d, 0x09) ^ multiply(e, 0x0e);
+        }
+    }
+}
+
+void AesBackend::encryptEcb(const quint8 *schedule, int rounds, const quint8 *in, quint8 *out, qsizetype blocks) {
+#ifdef AES_X86
+    if (active() == AesNi) {
+        niEncryptEcb(schedule, rounds, in, out, blocks);
+        return;
+    }
+#endif
+    portableEncryptEcb(schedule, rounds, in, out, blocks);
+}
+
+void AesBackend::decryptEcb(const quint8 *decSchedule, int rounds, const quint8 *in, quint8 *out, qsizetype blocks) {
+#ifdef AES_X86
+    if (active() == AesNi) {
+        niDecryptEcb(decSchedule, rounds, in, out, blocks);
+        return;
+    }
+#endif
+    portableDecryptEcb(decSchedule, rounds, in, out, blocks);
+}
+
+void AesBackend::encryptCbc(const quint8 *schedule, int rounds, quint8 *iv, const quint8 *in, quint8 *out, qsizetype blocks) {
+#ifdef AES_X86
+    if (active() == AesNi) {
+        niEncryptCbc(schedule, rounds, iv, in, out, blocks);
+        return;
+    }
+#endif
+    portableEncryptCbc(schedule, rounds, iv, in, out, blocks);
+}
+
+void AesBackend::decryptCbc(const quint8 *decSchedule, int rounds, quint8 *iv, const quint8 *in, quint8 *out, qsizetype blocks) {
+#ifdef AES_X86
+    if (active() == AesNi) {
+        niDecryptCbc(decSchedule, rounds, iv, in, out, blocks);
+        return;
+    }
+#endif
+    portableDecryptCbc(decSchedule, rounds, iv, in, out, blocks);
+}
@@ -0,0 +1,45 @@
+#ifndef AESBACKEND_H
+#define AESBACKEND_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Блокові операції AES для QAESEncryption: AES-NI або портативні T-таблиці
+ *
+ * Реалізація вибирається один раз за CPUID під час першого звернення: на процесорах
+ * x86/x86-64 з AES-NI працюють апаратні інструкції, на решті — табличний шифр
+ * (T-таблиці), який не залежить від платформи. Обидві дають однаковий результат.
+ *
+ * Розклад ключів (schedule) — це (rounds + 1) раундових ключів по 16 байт у порядку
+ * FIPS-197. Розклад для розшифрування — той самий у зворотному порядку, з InvMixColumns
+ * для проміжних раундів (equivalent inverse cipher), і його розуміють обидві реалізації.
+ *
+ * Функції CBC оновлюють iv на місці, тож довгий потік можна шифрувати частинами;
+ * in і out можуть збігатися.
+ */
+class AesBackend {
+public:
+    enum Kind {
+        Portable,  // T-таблиці, будь-який процесор
+        AesNi      // інструкції AES-NI (x86/x86-64)
+    };
+
+    static constexpr int BlockSize = 16;
+    static constexpr int MaxScheduleSize = 240;  // 15 раундових ключів AES-256
+
+    static Kind active();
+    static bool isSupported(Kind kind);
+    static bool setActive(Kind kind);  // 🔹 Примусовий вибір (самоперевірка, бенчмарк); false — не підтримується
+    static const char *name(Kind kind);
+
+    static int rounds(int keyLen);  // 🔹 10/12/14 для ключа 16/24/32 байти; 0 — недопустима довжина
+    static void expandEncryptKey(const quint8 *key, int keyLen, quint8 *schedule);
+    static void makeDecryptKey(const quint8 *encSchedule, int rounds, quint8 *decSchedule);
+
+    static void encryptEcb(const quint8 *schedule, int rounds, const quint8 *in, quint8 *out, qsizetype blocks);
+    static void decryptEcb(const quint8 *decSchedule, int rounds, const quint8 *in, quint8 *out, qsizetype blocks);
+    static void encryptCbc(const quint8 *schedule, int rounds, quint8 *iv, const quint8 *in, quint8 *out, qsizetype blocks);
+    static void decryptCbc(const quint8 *decSchedule, int rounds, quint8 *iv, const quint8 *in, quint8 *out, qsizetype blocks);
+};
+
+#endif // AESBACKEND_H
@@ -0,0 +1,32 @@
+#ifndef CLIENTDBPARAMS_H
+#define CLIENTDBPARAMS_H
+
+#include <QString>
+#include <QCryptographicHash>
+
+// Структура з параметрами підключення до бази клієнта
+struct ClientDBParams {
+    QString server;
+    int port;
+    QString database;
+    QString username;
+    QString password;
+    int statementTimeoutMs = 0;  // SET STATEMENT TIMEOUT для нових підключень (Firebird 4+); 0 — без ліміту
+
+    /**
+     * @brief Мітка підключення без пароля (для логів та статистики)
+     */
+    QString label() const {
+        return QString("%1:%2/%3@%4").arg(server).arg(port).arg(database, username);
+    }
+
+    /**
+     * @brief Ключ пулу підключень: усі параметри, пароль враховується лише як хеш
+     */
+    QString poolKey() const {
+        const QByteArray passHash = QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha1).toHex().left(12);
+        return label() + "#" + QString::fromLatin1(passHash);
+    }
+};
+
+#endif // CLIENTDBPARAMS_H
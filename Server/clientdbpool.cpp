@@ -0,0 +1,590 @@
+#include "clientdbpool.h"
+#include <QDebug>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QJsonArray>
+#include <QDeadlineTimer>
+
+/**
+ * @brief Конструктор оренди, викликається лише пулом
+ */
+ClientDBLease::ClientDBLease(ClientDBPool *pool, const QString &key, const QString &name,
+                             std::shared_ptr<StatementCache> statements)
+    : pool(pool), key(key), name(name), statements(std::move(statements)) {}
+
+ClientDBLease::~ClientDBLease() {
+    release();
+}
+
+ClientDBLease::ClientDBLease(ClientDBLease &&other) noexcept
+    : pool(other.pool), key(std::move(other.key)), name(std::move(other.name)),
+      statements(std::move(other.statements)), broken(other.broken) {
+    other.pool = nullptr;
+}
+
+ClientDBLease &ClientDBLease::operator=(ClientDBLease &&other) noexcept {
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        key = std::move(other.key);
+        name = std::move(other.name);
+        statements = std::move(other.statements);
+        broken = other.broken;
+        other.pool = nullptr;
+    }
+    return *this;
+}
+
+/**
+ * @brief Повертає орендоване підключення (невалідне, якщо оренда порожня)
+ */
+QSqlDatabase ClientDBLease::database() const {
+    if (!pool) {
+        return QSqlDatabase();
+    }
+    return QSqlDatabase::database(name, false);
+}
+
+/**
+ * @brief Повертає підготовлений запит орендованого підключення
+ * @param statementName Ім'я запиту в реєстрі підключення
+ * @param sql Текст запиту
+ * @return Запит, готовий до bindValue()/exec()
+ */
+QSqlQuery &ClientDBLease::statement(const QString &statementName, const QString &sql) {
+    Q_ASSERT(pool && statements);
+    return statements->prepare(database(), statementName, sql);
+}
+
+/**
+ * @brief Повертає підключення в пул; повторний виклик нічого не робить
+ */
+void ClientDBLease::release() {
+    if (!pool) {
+        return;
+    }
+    ClientDBPool *owner = pool;
+    pool = nullptr;
+    owner->release(key, name, std::move(statements), broken);
+}
+
+
+/**
+ * @brief Конструктор пулу
+ * @param settings Розміри пулу та таймаути
+ * @param parent Батьківський QObject
+ */
+ClientDBPool::ClientDBPool(const ClientDBPoolSettings &settings, QObject *parent)
+    : QObject(parent), settings(settings) {
+    if (this->settings.maxSize < 1) {
+        this->settings.maxSize = 1;
+    }
+    this->settings.keepIdle = qBound(0, this->settings.keepIdle, this->settings.maxSize);
+
+    // 🔹 Періодично закриваємо підключення, що довго простоюють
+    evictionTimer.setInterval(qBound(1, this->settings.idleTimeoutSec / 2, 60) * 1000);
+    connect(&evictionTimer, &QTimer::timeout, this, [this]() { evictIdle(); });
+    evictionTimer.start();
+
+    qInfo() << "✅ Пул підключень до БД клієнтів: keep_idle =" << this->settings.keepIdle
+            << ", max =" << this->settings.maxSize
+            << ", idle_timeout =" << this->settings.idleTimeoutSec << "с";
+}
+
+/**
+ * @brief Закриває решту підключень
+ *
+ * Пули робочих потоків Server зупиняються раніше, і кожен їхній потік уже закрив свої
+ * підключення в closeThreadConnections(); тут лишаються лише підключення поточного потоку.
+ */
+ClientDBPool::~ClientDBPool() {
+    QList<IdleConnection> toClose;
+    {
+        QMutexLocker locker(&mutex);
+        for (Bucket &bucket : buckets) {
+            toClose.append(bucket.idle);
+            bucket.idle.clear();
+        }
+        for (QList<IdleConnection> &connections : retired) {
+            toClose.append(connections);
+        }
+        retired.clear();
+    }
+    for (IdleConnection &conn : toClose) {
+        closeConnection(conn.name, std::move(conn.statements));
+    }
+}
+
+/**
+ * @brief Видає підключення до бази клієнта з пулу
+ * @param params Параметри підключення до БД клієнта
+ * @return Оренда підключення; невалідна, якщо підключитися не вдалося або сплив час очікування
+ */
+ClientDBLease ClientDBPool::acquire(const ClientDBParams &params) {
+    const QString key = params.poolKey();
+    QElapsedTimer waitTimer;
+    waitTimer.start();
+
+    closeRetired();
+
+    QMutexLocker locker(&mutex);
+    if (!buckets.contains(key)) {
+        buckets[key].params = params;
+    }
+    watchThread(QThread::currentThread());
+
+    auto lease = [&](Bucket &bucket, const QString &name, std::shared_ptr<StatementCache> statements) {
+        bucket.borrows++;
+        bucket.totalWaitMs += waitTimer.elapsed();
+        bucket.peakInUse = qMax(bucket.peakInUse, bucket.inUse);
+        return ClientDBLease(this, key, name, std::move(statements));
+    };
+
+    forever {
+        Bucket *bucket = &buckets[key];
+
+        // 🔹 1. Є вільне підключення цього потоку — беремо останнє повернуте (LIFO)
+        const int ownIndex = findOwnIdle(bucket->idle);
+        if (ownIndex >= 0) {
+            IdleConnection conn = bucket->idle.takeAt(ownIndex);
+            bucket->inUse++;
+
+            if (conn.idleTimer.hasExpired(qint64(settings.validateIdleSec) * 1000)) {
+                locker.unlock();
+                const bool healthy = isHealthy(conn.name);
+                if (!healthy) {
+                    closeConnection(conn.name, std::move(conn.statements));
+                }
+                locker.relock();
+                bucket = &buckets[key];
+
+                if (!healthy) {
+                    qWarning() << "⚠️ Підключення не пройшло перевірку, закриваємо:" << conn.name;
+                    bucket->inUse--;
+                    bucket->total--;
+                    bucket->healthCheckFailures++;
+                    available.wakeAll();
+                    continue;
+                }
+            }
+
+            bucket->reused++;
+            qDebug() << "🔸 Використовуємо підключення з пулу:" << conn.name;
+            return lease(*bucket, conn.name, std::move(conn.statements));
+        }
+
+        // 🔹 2. Є місце в пулі або вільне підключення іншого потоку, яке можна замінити
+        if (bucket->total < settings.maxSize || !bucket->idle.isEmpty()) {
+            // 🔹 Запобіжник розімкнено — не чекаємо тайм-ауту TCP, відмовляємо одразу
+            if (!allowOpen(*bucket)) {
+                bucket->breakerRejections++;
+                return ClientDBLease();
+            }
+
+            // 🔹 Чуже підключення закриє його потік-власник, а місце в пулі звільняється вже зараз
+            if (bucket->total < settings.maxSize) {
+                bucket->total++;
+            } else {
+                retire(bucket->idle.takeFirst());
+                bucket->evicted++;
+            }
+            bucket->inUse++;
+            const QString name = QString("clientDB_%1_%2").arg(params.server).arg(++nextConnectionId);
+
+            // 🔹 Підключаємося поза м'ютексом, щоб не блокувати інші потоки
+            locker.unlock();
+            const bool opened = openConnection(params, name);
+            locker.relock();
+            bucket = &buckets[key];
+            recordOpenResult(*bucket, opened);
+
+            if (!opened) {
+                bucket->total--;
+                bucket->inUse--;
+                bucket->openFailures++;
+                available.wakeAll();
+                return ClientDBLease();
+            }
+
+            bucket->created++;
+            return lease(*bucket, name, std::make_shared<StatementCache>());
+        }
+
+        // 🔹 3. Усі підключення зайняті — чекаємо в черзі
+        const qint64 remaining = settings.borrowTimeoutMs - waitTimer.elapsed();
+        if (remaining <= 0) {
+            bucket->waitTimeouts++;
+            qWarning() << "❌ Вичерпано пул підключень до" << params.label()
+                       << "— час очікування минув (" << settings.borrowTimeoutMs << "мс)";
+            return ClientDBLease();
+        }
+
+        bucket->waiting++;
+        available.wait(&mutex, QDeadlineTimer(remaining));
+        buckets[key].waiting--;
+    }
+}
+
+/**
+ * @brief Чи можна відкривати нове підключення з огляду на запобіжник (під м'ютексом)
+ *
+ * Розімкнений запобіжник після breakerOpenSec пропускає рівно одну пробну спробу.
+ */
+bool ClientDBPool::allowOpen(Bucket &bucket) {
+    switch (bucket.breaker) {
+    case Breaker::Closed:
+        return true;
+    case Breaker::Open:
+        if (!bucket.breakerOpened.hasExpired(qint64(settings.breakerOpenSec) * 1000)) {
+            return false;
+        }
+        bucket.breaker = Breaker::HalfOpen;
+        bucket.trialInFlight = true;
+        qInfo() << "🔸 Пробне підключення до" << bucket.params.label() << "(запобіжник half-open)";
+        return true;
+    case Breaker::HalfOpen:
+        if (bucket.trialInFlight) {
+            return false;
+        }
+        bucket.trialInFlight = true;
+        return true;
+    }
+    return true;
+}
+
+/**
+ * @brief Оновлює запобіжник за результатом підключення (під м'ютексом)
+ */
+void ClientDBPool::recordOpenResult(Bucket &bucket, bool opened) {
+    bucket.trialInFlight = false;
+    if (opened) {
+        if (bucket.breaker != Breaker::Closed) {
+            qInfo() << "✅ База клієнта знову доступна, запобіжник замкнено:" << bucket.params.label();
+        }
+        bucket.breaker = Breaker::Closed;
+        bucket.consecutiveFailures = 0;
+        return;
+    }
+
+    bucket.consecutiveFailures++;
+    const bool trip = bucket.breaker == Breaker::HalfOpen
+                      || (settings.breakerFailures > 0 && bucket.consecutiveFailures >= settings.breakerFailures);
+    if (trip) {
+        if (bucket.breaker == Breaker::Closed) {
+            bucket.breakerTrips++;
+            qCritical() << "❌ Запобіжник розімкнено для" << bucket.params.label() << "після"
+                        << bucket.consecutiveFailures << "невдалих підключень";
+        }
+        bucket.breaker = Breaker::Open;
+        bucket.breakerOpened.start();
+    }
+}
+
+/**
+ * @brief Враховує результат фонової перевірки бази (HealthMonitor)
+ *
+ * Успішна перевірка замикає запобіжник одразу, не чекаючи breakerOpenSec;
+ * невдала — лише продовжує час розмикання, якщо запобіжник уже розімкнено.
+ */
+void ClientDBPool::reportProbe(const ClientDBParams &params, bool ok) {
+    QMutexLocker locker(&mutex);
+    auto it = buckets.find(params.poolKey());
+    if (it == buckets.end() || it->breaker == Breaker::Closed) {
+        return;
+    }
+    if (ok) {
+        recordOpenResult(*it, true);
+    } else if (it->breaker == Breaker::Open) {
+        it->breakerOpened.start();
+    }
+}
+
+const char *ClientDBPool::breakerName(Breaker state) {
+    switch (state) {
+    case Breaker::Closed:
+        return "closed";
+    case Breaker::Open:
+        return "open";
+    case Breaker::HalfOpen:
+        return "half_open";
+    }
+    return "closed";
+}
+
+/**
+ * @brief Стан запобіжника бази клієнта
+ */
+QString ClientDBPool::breakerState(const ClientDBParams &params) const {
+    QMutexLocker locker(&mutex);
+    auto it = buckets.constFind(params.poolKey());
+    return QLatin1String(breakerName(it != buckets.constEnd() ? it->breaker : Breaker::Closed));
+}
+
+/**
+ * @brief Повертає підключення в пул (викликається з ClientDBLease)
+ */
+void ClientDBPool::release(const QString &key, const QString &name,
+                           std::shared_ptr<StatementCache> statements, bool broken) {
+    QMutexLocker locker(&mutex);
+    auto it = buckets.find(key);
+    if (it == buckets.end()) {
+        locker.unlock();
+        closeConnection(name, std::move(statements));
+        return;
+    }
+
+    it->inUse--;
+    if (broken) {
+        it->total--;
+        locker.unlock();
+        closeConnection(name, std::move(statements));
+    } else {
+        IdleConnection conn;
+        conn.name = name;
+        conn.owner = QThread::currentThread();
+        conn.idleTimer.start();
+        conn.statements = std::move(statements);
+        it->idle.append(conn);
+        locker.unlock();
+    }
+
+    available.wakeAll();
+    closeRetired();
+}
+
+/**
+ * @brief Віддає виведене з пулу підключення потоку-власнику на закриття (під м'ютексом)
+ *
+ * QIBASE не дозволяє закривати підключення з чужого потоку, тому тут воно лише
+ * записується в чергу свого потоку; закриє його closeRetired() або closeThreadConnections().
+ */
+void ClientDBPool::retire(IdleConnection &&conn) {
+    retired[conn.owner].append(std::move(conn));
+}
+
+/**
+ * @brief Закриває виведені з пулу підключення поточного потоку
+ */
+void ClientDBPool::closeRetired() {
+    QList<IdleConnection> toClose;
+    {
+        QMutexLocker locker(&mutex);
+        if (retired.isEmpty()) {
+            return;
+        }
+        toClose = retired.take(QThread::currentThread());
+    }
+
+    for (IdleConnection &conn : toClose) {
+        closeConnection(conn.name, std::move(conn.statements));
+    }
+    if (!toClose.isEmpty()) {
+        qDebug() << "🔸 Закрито виведених з пулу підключень:" << toClose.size();
+    }
+}
+
+/**
+ * @brief Підписується на завершення потоку, що бере підключення з пулу (під м'ютексом)
+ *
+ * Сигнал finished приходить у самому потоці, що завершується (Qt::DirectConnection),
+ * тож його підключення закриваються там, де були відкриті.
+ */
+void ClientDBPool::watchThread(QThread *thread) {
+    if (watchedThreads.contains(thread)) {
+        return;
+    }
+    watchedThreads.insert(thread);
+    connect(thread, &QThread::finished, this, [this, thread]() { closeThreadConnections(thread); },
+            Qt::DirectConnection);
+}
+
+/**
+ * @brief Закриває всі вільні та виведені з пулу підключення потоку, що завершується
+ */
+void ClientDBPool::closeThreadConnections(QThread *thread) {
+    QList<IdleConnection> toClose;
+    {
+        QMutexLocker locker(&mutex);
+        toClose = retired.take(thread);
+        for (Bucket &bucket : buckets) {
+            for (int i = int(bucket.idle.size()) - 1; i >= 0; --i) {
+                if (bucket.idle.at(i).owner == thread) {
+                    toClose.append(bucket.idle.takeAt(i));
+                    bucket.total--;
+                }
+            }
+        }
+        watchedThreads.remove(thread);
+    }
+
+    for (IdleConnection &conn : toClose) {
+        closeConnection(conn.name, std::move(conn.statements));
+    }
+    available.wakeAll();
+}
+
+/**
+ * @brief Виводить з пулу підключення, що простоюють довше idleTimeoutSec, залишаючи keepIdle на клієнта
+ *
+ * Закриває їх потік-власник (див. retire()); підключення поточного потоку закриваються одразу.
+ * @return Кількість виведених підключень
+ */
+int ClientDBPool::evictIdle() {
+    const qint64 idleTimeoutMs = qint64(settings.idleTimeoutSec) * 1000;
+    int evicted = 0;
+    {
+        QMutexLocker locker(&mutex);
+        for (Bucket &bucket : buckets) {
+            // 🔹 На початку списку — підключення, що простоюють найдовше
+            while (!bucket.idle.isEmpty() && bucket.total > settings.keepIdle
+                   && bucket.idle.first().idleTimer.hasExpired(idleTimeoutMs)) {
+                retire(bucket.idle.takeFirst());
+                bucket.total--;
+                bucket.evicted++;
+                evicted++;
+            }
+        }
+    }
+    closeRetired();
+
+    if (evicted > 0) {
+        qDebug() << "🔸 Виведено з пулу простоюючих підключень:" << evicted;
+    }
+    return evicted;
+}
+
+/**
+ * @brief Статистика пулу для підбору розмірів під навантаженням
+ */
+QJsonObject ClientDBPool::stats() const {
+    QMutexLocker locker(&mutex);
+
+    QJsonArray clients;
+    for (const Bucket &bucket : buckets) {
+        QJsonObject obj;
+        obj["connection"] = bucket.params.label();
+        obj["total"] = bucket.total;
+        obj["idle"] = int(bucket.idle.size());
+        obj["in_use"] = bucket.inUse;
+        obj["waiting"] = bucket.waiting;
+        obj["peak_in_use"] = bucket.peakInUse;
+        obj["borrows"] = qint64(bucket.borrows);
+        obj["created"] = qint64(bucket.created);
+        obj["reused"] = qint64(bucket.reused);
+        obj["evicted"] = qint64(bucket.evicted);
+        obj["open_failures"] = qint64(bucket.openFailures);
+        obj["health_check_failures"] = qint64(bucket.healthCheckFailures);
+        obj["wait_timeouts"] = qint64(bucket.waitTimeouts);
+        obj["avg_wait_ms"] = bucket.borrows > 0 ? double(bucket.totalWaitMs) / bucket.borrows : 0.0;
+        obj["breaker"] = QLatin1String(breakerName(bucket.breaker));
+        obj["consecutive_failures"] = bucket.consecutiveFailures;
+        obj["breaker_trips"] = qint64(bucket.breakerTrips);
+        obj["breaker_rejections"] = qint64(bucket.breakerRejections);
+        clients.append(obj);
+    }
+
+    qsizetype retiredCount = 0;
+    for (const QList<IdleConnection> &connections : retired) {
+        retiredCount += connections.size();
+    }
+
+    QJsonObject result;
+    result["keep_idle"] = settings.keepIdle;
+    result["max_size"] = settings.maxSize;
+    result["idle_timeout_sec"] = settings.idleTimeoutSec;
+    result["borrow_timeout_ms"] = settings.borrowTimeoutMs;
+    result["breaker_failures"] = settings.breakerFailures;
+    result["breaker_open_sec"] = settings.breakerOpenSec;
+    result["retired"] = qint64(retiredCount);  // 🔹 Виведені з пулу, але ще не закриті потоком-власником
+    result["clients"] = clients;
+    return result;
+}
+
+/**
+ * @brief Параметри всіх баз клієнтів, для яких у пулі є кошик
+ */
+QList<ClientDBParams> ClientDBPool::knownClients() const {
+    QMutexLocker locker(&mutex);
+    QList<ClientDBParams> result;
+    result.reserve(buckets.size());
+    for (const Bucket &bucket : buckets) {
+        result.append(bucket.params);
+    }
+    return result;
+}
+
+/**
+ * @brief Задає тайм-аут запитів для підключення (`SET STATEMENT TIMEOUT`, Firebird 4+)
+ *
+ * Старіші сервери цю команду не знають — тоді лишається лише сторожовий тайм-аут обробника.
+ */
+void ClientDBPool::applyStatementTimeout(QSqlDatabase &clientDB, const ClientDBParams &params) {
+    if (params.statementTimeoutMs <= 0) {
+        return;
+    }
+    QSqlQuery query(clientDB);
+    if (!query.exec(QString("SET STATEMENT TIMEOUT %1 MILLISECOND").arg(params.statementTimeoutMs))) {
+        qWarning() << "⚠️ Сервер" << params.label() << "не підтримує STATEMENT TIMEOUT:" << query.lastError().text();
+    }
+}
+
+/**
+ * @brief Відкриває нове іменоване підключення до бази клієнта
+ */
+bool ClientDBPool::openConnection(const ClientDBParams &params, const QString &name) {
+    {
+        QSqlDatabase clientDB = QSqlDatabase::addDatabase("QIBASE", name);
+        clientDB.setHostName(params.server);
+        clientDB.setPort(params.port);
+        clientDB.setDatabaseName(params.database);
+        clientDB.setUserName(params.username);
+        clientDB.setPassword(params.password);
+
+        if (clientDB.open()) {
+            qInfo() << "✅ Успішне підключення до бази клієнта:" << name;
+            applyStatementTimeout(clientDB, params);
+            return true;
+        }
+        qCritical() << "❌ Помилка підключення до бази клієнта:" << clientDB.lastError().text();
+    }
+    QSqlDatabase::removeDatabase(name);
+    return false;
+}
+
+/**
+ * @brief Перевіряє, що підключення живе, легким запитом до RDB$DATABASE
+ */
+bool ClientDBPool::isHealthy(const QString &name) {
+    QSqlDatabase clientDB = QSqlDatabase::database(name, false);
+    if (!clientDB.isOpen()) {
+        return false;
+    }
+    QSqlQuery query(clientDB);
+    return query.exec("SELECT 1 FROM RDB$DATABASE");
+}
+
+/**
+ * @brief Шукає вільне підключення, відкрите поточним потоком (з кінця списку)
+ * @return Індекс у списку або -1
+ */
+int ClientDBPool::findOwnIdle(const QList<IdleConnection> &idle) {
+    QThread *const current = QThread::currentThread();
+    for (int i = int(idle.size()) - 1; i >= 0; --i) {
+        if (idle.at(i).owner == current) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Закриває та видаляє іменоване підключення
+ *
+ * Спершу звільняються підготовлені запити підключення, інакше removeDatabase()
+ * попередить, що підключення ще використовується. Викликати лише в потоці, що
+ * відкрив підключення (чужі підключення — через retire()).
+ */
+void ClientDBPool::closeConnection(const QString &name, std::shared_ptr<StatementCache> statements) {
+    statements.reset();
+    QSqlDatabase::removeDatabase(name);
+}
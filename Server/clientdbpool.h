@@ -0,0 +1,165 @@
+#ifndef CLIENTDBPOOL_H
+#define CLIENTDBPOOL_H
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QTimer>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QThread>
+#include <QSqlQuery>
+#include <memory>
+#include "clientdbparams.h"
+#include "statementcache.h"
+
+class ClientDBPool;
+
+// Налаштування пулу підключень до баз клієнтів (секція [ClientPool] у config.ini)
+struct ClientDBPoolSettings {
+    int keepIdle = 1;            // скільки підключень на клієнта не закривати за простоєм (заздалегідь не відкриваються)
+    int maxSize = 4;             // максимум підключень на одного клієнта
+    int idleTimeoutSec = 300;    // через скільки секунд простою підключення закривається
+    int borrowTimeoutMs = 5000;  // скільки чекати вільне підключення в черзі
+    int validateIdleSec = 30;    // після якого простою перевіряти підключення запитом
+    int breakerFailures = 5;     // після скількох невдалих підключень поспіль розмикати запобіжник (0 — вимкнено)
+    int breakerOpenSec = 30;     // скільки секунд після розмикання не пробувати підключатися
+};
+
+/**
+ * @brief Оренда підключення з пулу (RAII): у деструкторі підключення повертається в пул
+ */
+class ClientDBLease {
+public:
+    ClientDBLease() = default;
+    ~ClientDBLease();
+    ClientDBLease(ClientDBLease &&other) noexcept;
+    ClientDBLease &operator=(ClientDBLease &&other) noexcept;
+    ClientDBLease(const ClientDBLease &) = delete;
+    ClientDBLease &operator=(const ClientDBLease &) = delete;
+
+    bool isValid() const { return pool != nullptr; }
+    explicit operator bool() const { return isValid(); }
+
+    QSqlDatabase database() const;
+    QString connectionName() const { return name; }
+    QString clientLabel() const { return key.left(key.lastIndexOf('#')); }  // 🔹 ClientDBParams::label() бази
+    QSqlQuery &statement(const QString &statementName, const QString &sql);
+
+    void invalidate() { broken = true; }  // 🔹 Підключення буде закрите при поверненні
+    void release();                       // 🔹 Достроково повернути підключення в пул
+
+private:
+    friend class ClientDBPool;
+    ClientDBLease(ClientDBPool *pool, const QString &key, const QString &name,
+                  std::shared_ptr<StatementCache> statements);
+
+    ClientDBPool *pool = nullptr;
+    QString key;
+    QString name;
+    std::shared_ptr<StatementCache> statements;  // підготовлені запити цього підключення
+    bool broken = false;
+};
+
+/**
+ * @brief Обмежений пул підключень до баз клієнтів.
+ *
+ * Ключ пулу — повний набір ClientDBParams (сервер, порт, файл, користувач, пароль).
+ * Для кожного ключа тримається не більше maxSize підключень; якщо всі зайняті,
+ * запит чекає в черзі до borrowTimeoutMs. Перед видачею підключення, яке довго
+ * простоювало, перевіряється легким запитом.
+ *
+ * QSqlDatabase можна використовувати (і закривати) лише в потоці, що його створив, тому
+ * кожне підключення закріплене за своїм потоком: потік отримує лише власні вільні
+ * підключення, а коли ліміт вичерпано — найстаріше чуже вільне виводиться з пулу,
+ * і на його місці відкривається нове. Виведені з пулу (так само й ті, що простояли
+ * idleTimeoutSec) підключення закриває їхній потік-власник: при наступному зверненні
+ * до пулу або при своєму завершенні (QThread::finished). До того вони лишаються
+ * відкритими поза лімітом maxSize.
+ *
+ * Разом з підключенням у пулі живуть його підготовлені запити (StatementCache),
+ * тож повторна оренда не готує їх заново; при закритті підключення вони звільняються.
+ *
+ * Для кожного ключа діє запобіжник (circuit breaker): після breakerFailures невдалих
+ * підключень поспіль він розмикається, і нові підключення не відкриваються breakerOpenSec
+ * секунд — запити одразу отримують відмову замість очікування тайм-ауту TCP. Потім одна
+ * пробна спроба (half-open) вирішує, замкнути його чи розімкнути знову. Фонова перевірка
+ * (reportProbe) замикає запобіжник, щойно база знову відповідає.
+ */
+class ClientDBPool : public QObject {
+    Q_OBJECT
+public:
+    explicit ClientDBPool(const ClientDBPoolSettings &settings, QObject *parent = nullptr);
+    ~ClientDBPool();
+
+    ClientDBLease acquire(const ClientDBParams &params);
+    int evictIdle();          // 🔹 Виводить з пулу підключення, що простоюють довше idleTimeoutSec
+    QJsonObject stats() const;
+    QList<ClientDBParams> knownClients() const;  // 🔹 Бази, до яких сервер уже звертався
+    void reportProbe(const ClientDBParams &params, bool ok);  // 🔹 Результат фонової перевірки бази
+    QString breakerState(const ClientDBParams &params) const;  // 🔹 closed / open / half_open
+
+private:
+    friend class ClientDBLease;
+
+    struct IdleConnection {
+        QString name;
+        QThread *owner = nullptr;  // потік, що відкрив підключення
+        QElapsedTimer idleTimer;
+        std::shared_ptr<StatementCache> statements;
+    };
+
+    enum class Breaker { Closed, Open, HalfOpen };
+
+    struct Bucket {
+        ClientDBParams params;
+        Breaker breaker = Breaker::Closed;
+        int consecutiveFailures = 0;
+        bool trialInFlight = false;  // у стані HalfOpen вже йде пробне підключення
+        QElapsedTimer breakerOpened;
+        quint64 breakerTrips = 0;
+        quint64 breakerRejections = 0;
+        QList<IdleConnection> idle;
+        int total = 0;        // відкриті + ті, що відкриваються зараз
+        int inUse = 0;
+        int waiting = 0;
+        int peakInUse = 0;
+        quint64 created = 0;
+        quint64 reused = 0;
+        quint64 evicted = 0;
+        quint64 openFailures = 0;
+        quint64 healthCheckFailures = 0;
+        quint64 waitTimeouts = 0;
+        quint64 borrows = 0;
+        qint64 totalWaitMs = 0;
+    };
+
+    void release(const QString &key, const QString &name, std::shared_ptr<StatementCache> statements, bool broken);
+    static int findOwnIdle(const QList<IdleConnection> &idle);
+    void retire(IdleConnection &&conn);  // під м'ютексом
+    void closeRetired();
+    void watchThread(QThread *thread);   // під м'ютексом
+    void closeThreadConnections(QThread *thread);
+    bool allowOpen(Bucket &bucket);
+    void recordOpenResult(Bucket &bucket, bool opened);
+    static const char *breakerName(Breaker state);
+    bool openConnection(const ClientDBParams &params, const QString &name);
+    bool isHealthy(const QString &name);
+    static void applyStatementTimeout(QSqlDatabase &clientDB, const ClientDBParams &params);
+    static void closeConnection(const QString &name, std::shared_ptr<StatementCache> statements = {});
+
+    ClientDBPoolSettings settings;
+    mutable QMutex mutex;
+    QWaitCondition available;
+    QHash<QString, Bucket> buckets;
+    QHash<QThread *, QList<IdleConnection>> retired;  // виведені з пулу підключення, які має закрити потік-власник
+    QSet<QThread *> watchedThreads;                    // потоки, на чиє завершення вже підписано closeThreadConnections()
+    quint64 nextConnectionId = 0;
+    QTimer evictionTimer;
+};
+
+#endif // CLIENTDBPOOL_H
@@ -0,0 +1,61 @@
+#include "clientparamscache.h"
+
+/**
+ * @brief Конструктор кешу
+ * @param ttlSec Час життя запису в секундах; 0 вимикає кеш
+ */
+ClientParamsCache::ClientParamsCache(int ttlSec) : ttlSec(ttlSec), hits(0), misses(0) {}
+
+/**
+ * @brief Повертає параметри клієнта, якщо вони є в кеші і ще не застаріли
+ */
+std::optional<ClientDBParams> ClientParamsCache::get(int clientId) {
+    if (!isEnabled()) {
+        return std::nullopt;
+    }
+
+    QReadLocker locker(&lock);
+    auto it = entries.constFind(clientId);
+    if (it == entries.constEnd() || it->expires.hasExpired()) {
+        misses.fetchAndAddRelaxed(1);
+        return std::nullopt;
+    }
+
+    hits.fetchAndAddRelaxed(1);
+    return it->params;
+}
+
+/**
+ * @brief Зберігає параметри клієнта на ttlSec секунд
+ */
+void ClientParamsCache::put(int clientId, const ClientDBParams &params) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    QWriteLocker locker(&lock);
+    Entry &entry = entries[clientId];
+    entry.params = params;
+    entry.expires = QDeadlineTimer(qint64(ttlSec) * 1000);
+}
+
+void ClientParamsCache::invalidate(int clientId) {
+    QWriteLocker locker(&lock);
+    entries.remove(clientId);
+}
+
+void ClientParamsCache::invalidateAll() {
+    QWriteLocker locker(&lock);
+    entries.clear();
+}
+
+QJsonObject ClientParamsCache::stats() const {
+    QReadLocker locker(&lock);
+    QJsonObject result;
+    result["enabled"] = isEnabled();
+    result["ttl_sec"] = ttlSec;
+    result["entries"] = int(entries.size());
+    result["hits"] = qint64(hits.loadRelaxed());
+    result["misses"] = qint64(misses.loadRelaxed());
+    return result;
+}
@@ -0,0 +1,43 @@
+#ifndef CLIENTPARAMSCACHE_H
+#define CLIENTPARAMSCACHE_H
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QDeadlineTimer>
+#include <QJsonObject>
+#include <QAtomicInteger>
+#include <optional>
+#include "clientdbparams.h"
+
+/**
+ * @brief Кеш розшифрованих параметрів підключення до баз клієнтів
+ *
+ * Рядки `clients_settings` змінюються рідко, тому параметри тримаються в пам'яті
+ * ttlSec секунд: на гарячому шляху немає ні запиту до основної бази, ні AES.
+ * Читання йде під спільним блокуванням, тож робочі потоки не заважають одне одному.
+ */
+class ClientParamsCache {
+public:
+    explicit ClientParamsCache(int ttlSec);
+
+    bool isEnabled() const { return ttlSec > 0; }
+    std::optional<ClientDBParams> get(int clientId);
+    void put(int clientId, const ClientDBParams &params);
+    void invalidate(int clientId);
+    void invalidateAll();
+    QJsonObject stats() const;
+
+private:
+    struct Entry {
+        ClientDBParams params;
+        QDeadlineTimer expires;
+    };
+
+    int ttlSec;
+    mutable QReadWriteLock lock;
+    QHash<int, Entry> entries;
+    QAtomicInteger<quint64> hits;
+    QAtomicInteger<quint64> misses;
+};
+
+#endif // CLIENTPARAMSCACHE_H
@@ -0,0 +1,127 @@
+#include "compression.h"
+#include <QList>
+#include <array>
+
+/**
+ * @brief Вибирає кодування за Accept-Encoding: gzip, потім deflate; `q=0` забороняє кодування
+ *
+ * `*` дозволяє gzip, якщо його не вказано окремо.
+ */
+Compression::Encoding Compression::negotiate(const QByteArray &acceptEncoding) {
+    if (acceptEncoding.isEmpty()) {
+        return Identity;
+    }
+
+    double gzipQ = -1;
+    double deflateQ = -1;
+    double anyQ = -1;
+    for (const QByteArray &item : acceptEncoding.split(',')) {
+        const QList<QByteArray> parts = item.split(';');
+        const QByteArray coding = parts.first().trimmed().toLower();
+        double q = 1.0;
+        for (qsizetype i = 1; i < parts.size(); ++i) {
+            const QByteArray param = parts[i].trimmed();
+            if (param.startsWith("q=")) {
+                bool ok = false;
+                q = param.mid(2).toDouble(&ok);
+                if (!ok) {
+                    q = 0;
+                }
+            }
+        }
+
+        if (coding == "gzip" || coding == "x-gzip") {
+            gzipQ = q;
+        } else if (coding == "deflate") {
+            deflateQ = q;
+        } else if (coding == "*") {
+            anyQ = q;
+        }
+    }
+
+    if (gzipQ < 0) {
+        gzipQ = anyQ;
+    }
+    if (gzipQ > 0 && gzipQ >= deflateQ) {
+        return Gzip;
+    }
+    return deflateQ > 0 ? Deflate : Identity;
+}
+
+QByteArray Compression::compress(const QByteArray &data, Encoding encoding, int level) {
+    switch (encoding) {
+    case Gzip:
+        return gzip(data, level);
+    case Deflate:
+        return deflate(data, level);
+    case Identity:
+        break;
+    }
+    return data;
+}
+
+const char *Compression::name(Encoding encoding) {
+    switch (encoding) {
+    case Gzip:
+        return "gzip";
+    case Deflate:
+        return "deflate";
+    case Identity:
+        break;
+    }
+    return "identity";
+}
+
+/**
+ * @brief CRC-32 (IEEE 802.3), як вимагає трейлер gzip
+ */
+quint32 Compression::crc32(const char *data, qsizetype size, quint32 crc) {
+    static const auto table = []() {
+        std::array<quint32, 256> t{};
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (qsizetype i = 0; i < size; ++i) {
+        crc = table[(crc ^ uchar(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void appendLe32(QByteArray &out, quint32 value) {
+    for (int i = 0; i < 4; ++i) {
+        out.append(char((value >> (8 * i)) & 0xFF));
+    }
+}
+
+/**
+ * @brief Стискає дані в один gzip-член (RFC 1952) на основі qCompress
+ *
+ * qCompress повертає 4 байти довжини + zlib-потік (2 байти заголовка, deflate, 4 байти adler32);
+ * для gzip потрібен лише сирий deflate, до якого додаються заголовок gzip, CRC-32 та довжина.
+ */
+QByteArray Compression::gzip(const QByteArray &data, int level) {
+    const QByteArray zlib = qCompress(data, level);
+    QByteArray out;
+    out.reserve(zlib.size() + 18);
+    static const char header[] = {'\x1f', '\x8b', '\x08', 0, 0, 0, 0, 0, 0, '\x03'};
+    out.append(header, sizeof(header));
+    out.append(zlib.constData() + 6, zlib.size() - 10);
+    appendLe32(out, crc32(data.constData(), data.size()));
+    appendLe32(out, quint32(data.size()));
+    return out;
+}
+
+/**
+ * @brief zlib-потік для `Content-Encoding: deflate` — результат qCompress без 4 байтів довжини
+ */
+QByteArray Compression::deflate(const QByteArray &data, int level) {
+    return qCompress(data, level).mid(4);
+}
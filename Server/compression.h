@@ -0,0 +1,26 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <QByteArray>
+
+/**
+ * @brief Стиснення тіл HTTP-відповідей та архівів логів (gzip/deflate на основі qCompress)
+ */
+class Compression {
+public:
+    enum Encoding {
+        Identity,
+        Gzip,     // RFC 1952
+        Deflate   // zlib-потік (RFC 1950), як того вимагає `Content-Encoding: deflate`
+    };
+
+    static Encoding negotiate(const QByteArray &acceptEncoding);  // 🔹 Вибір за заголовком Accept-Encoding
+    static QByteArray compress(const QByteArray &data, Encoding encoding, int level = 6);
+    static QByteArray gzip(const QByteArray &data, int level = 6);
+    static QByteArray deflate(const QByteArray &data, int level = 6);
+    static const char *name(Encoding encoding);  // 🔹 Значення для Content-Encoding
+
+    static quint32 crc32(const char *data, qsizetype size, quint32 crc = 0);
+};
+
+#endif // COMPRESSION_H
@@ -1,25 +1,63 @@
 #include "criptpass.h"
 #include "qaesencryption.h"
+#include "aesbackend.h"
 #include <QCryptographicHash>
+#include <cstring>
 
-CriptPass::CriptPass() {
-    const QString key = "SapForever";  // Винеси в конфігурацію
-    const QString iv = "Poltava1970Rust";
+namespace {
 
-    hashKey = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha256);
-    hashIV = QCryptographicHash::hash(iv.toUtf8(), QCryptographicHash::Md5);
+// 🔹 Незмінний після створення, тому читається з будь-якого потоку без синхронізації
+struct CipherContext {
+    QAESEncryption aes{QAESEncryption::AES_256, QAESEncryption::CBC};
+    quint8 encryptKey[AesBackend::MaxScheduleSize];
+    quint8 decryptKey[AesBackend::MaxScheduleSize];
+    quint8 iv[AesBackend::BlockSize];
+
+    CipherContext() {
+        const QString key = "SapForever";  // Винеси в конфігурацію
+        const QString ivText = "Poltava1970Rust";
+
+        const QByteArray hashKey = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha256);
+        const QByteArray hashIV = QCryptographicHash::hash(ivText.toUtf8(), QCryptographicHash::Md5);
+
+        aes.expandKey(reinterpret_cast<const quint8 *>(hashKey.constData()), encryptKey, true);
+        aes.expandKey(reinterpret_cast<const quint8 *>(hashKey.constData()), decryptKey, false);
+        std::memcpy(iv, hashIV.constData(), sizeof(iv));
+    }
+};
+
+const CipherContext &cipherContext() {
+    static const CipherContext context;  // 🔹 Ініціалізація потокобезпечна (C++11 magic static)
+    return context;
 }
 
+} // namespace
+
 QString CriptPass::encryptPassword(const QString &plainText) {
-    QAESEncryption encryption(QAESEncryption::AES_256, QAESEncryption::CBC);
-    QByteArray encoded = encryption.encode(plainText.toUtf8(), hashKey, hashIV);
+    const CipherContext &context = cipherContext();
+    const QByteArray plain = plainText.toUtf8();
+
+    QByteArray encoded(context.aes.paddedSize(plain.size()), Qt::Uninitialized);
+    quint8 *buffer = reinterpret_cast<quint8 *>(encoded.data());
+    std::memcpy(buffer, plain.constData(), size_t(plain.size()));
+    context.aes.pad(buffer, plain.size());
+
+    quint8 iv[AesBackend::BlockSize];
+    std::memcpy(iv, context.iv, sizeof(iv));
+    context.aes.encryptBlocks(context.encryptKey, iv, buffer, buffer, encoded.size());
     return QString(encoded.toBase64());
 }
 
 QString CriptPass::decryptPassword(const QString &encryptedBase64) {
-    QAESEncryption encryption(QAESEncryption::AES_256, QAESEncryption::CBC);
-    QByteArray decoded = encryption.decode(QByteArray::fromBase64(encryptedBase64.toUtf8()), hashKey, hashIV);
-    return QString(encryption.removePadding(decoded));
+    const CipherContext &context = cipherContext();
+    QByteArray decoded = QByteArray::fromBase64(encryptedBase64.toUtf8());
+    decoded.truncate(decoded.size() - decoded.size() % AesBackend::BlockSize);  // 🔹 Неповний останній блок відкидається
+
+    quint8 iv[AesBackend::BlockSize];
+    std::memcpy(iv, context.iv, sizeof(iv));
+    quint8 *buffer = reinterpret_cast<quint8 *>(decoded.data());
+    context.aes.decryptBlocks(context.decryptKey, iv, buffer, buffer, decoded.size());
+    return QString(QAESEncryption::RemovePadding(decoded, QAESEncryption::ISO));
 }
 
 QString CriptPass::cryptVNCPass(const QString &termID, const QString &pass) {
@@ -32,4 +70,3 @@ QString CriptPass::decryptVNCPass(const QString &pass) {
     QString decrypted = decryptPassword(pass);
     return decrypted.mid(3, decrypted.length() - 5);
 }
-
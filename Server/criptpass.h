@@ -6,19 +6,20 @@
 
 class Config;  // forward declaration
 
+/**
+ * @brief Шифрування паролів баз клієнтів (AES-256-CBC, ISO-доповнення, Base64)
+ *
+ * Ключ (SHA-256) та IV (MD5) обчислюються, а розклади ключів для шифрування й
+ * розшифрування розгортаються один раз на процес; далі їх спільно й без блокувань
+ * використовують усі потоки, тож розшифрування пароля — це кілька блокових операцій.
+ */
 class CriptPass {
 public:
-    CriptPass();
+    static QString encryptPassword(const QString& plainText);
+    static QString decryptPassword(const QString& encryptedText);
 
-    QString encryptPassword(const QString& plainText);
-    QString decryptPassword(const QString& encryptedText);
-
-    QString cryptVNCPass(const QString& termID, const QString& pass);
-    QString decryptVNCPass(const QString& pass);
-
-private:
-    QByteArray hashKey;
-    QByteArray hashIV;
+    static QString cryptVNCPass(const QString& termID, const QString& pass);
+    static QString decryptVNCPass(const QString& pass);
 };
 
 #endif // CRIPTPASS_H
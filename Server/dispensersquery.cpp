@@ -0,0 +1,122 @@
+#include "dispensersquery.h"
+#include "requesttrace.h"
+#include <QJsonObject>
+#include <QStringList>
+#include <QVariant>
+
+/**
+ * @brief Розмір списку IN (...) для частини з count АЗС: найближчий степінь двійки, не більше kInListChunkSize
+ *
+ * Так на підключення готується не більше ~10 варіантів запиту замість окремого для кожної довжини.
+ */
+qsizetype inListBucket(qsizetype count) {
+    qsizetype bucket = 1;
+    while (bucket < count) {
+        bucket *= 2;
+    }
+    return qMin(bucket, qsizetype(kInListChunkSize));
+}
+
+/**
+ * @brief Формує список позиційних параметрів `?, ?, ?` для IN (...)
+ */
+QString inPlaceholders(qsizetype count) {
+    QStringList marks;
+    marks.reserve(count);
+    for (qsizetype i = 0; i < count; ++i) {
+        marks.append("?");
+    }
+    return marks.join(", ");
+}
+
+/**
+ * @brief SQL-запит ТРК разом із пістолетами одним проходом
+ *
+ * Кожен рядок — ТРК + один її пістолет (або NULL-и, якщо пістолетів немає),
+ * відсортовано за terminal_id, dispenser_id, pump_id.
+ * Пістолети без резервуара відкидаються всередині похідної таблиці, як і раніше.
+ * @param terminalFilter Умова для terminal_id: `= ?` або `IN (?, ?, ...)`; параметри
+ *        прив'язуються двічі — спершу для пістолетів, потім для ТРК
+ */
+QString dispensersWithPumpsSql(const QString &terminalFilter) {
+    return QString(R"(
+        SELECT d.terminal_id, d.dispenser_id, p.name, d.channelport, d.channelspeed, d.netaddress,
+               pm.pump_id, pm.tank_id, pm.shortname
+        FROM dispensers d
+        LEFT JOIN protocols p ON p.protocol_id = d.protocol_id
+        LEFT JOIN (
+            SELECT t.terminal_id, t.dispenser_id, t.trk_id AS pump_id, t.tank_id, f.shortname
+            FROM trks t
+            JOIN tanks s ON s.tank_id = t.tank_id AND s.terminal_id = t.terminal_id
+            LEFT JOIN fuels f ON f.fuel_id = s.fuel_id
+            WHERE t.terminal_id %1 AND t.isactive = 'T'
+        ) pm ON pm.terminal_id = d.terminal_id AND pm.dispenser_id = d.dispenser_id
+        WHERE d.terminal_id %1 AND d.isactive = 'T'
+          AND p.postype_id = (SELECT s.postype_id FROM POSS s WHERE s.terminal_id = d.terminal_id AND s.pos_id = 1)
+        ORDER BY d.terminal_id, d.dispenser_id, pm.pump_id
+    )").arg(terminalFilter);
+}
+
+/**
+ * @brief Будує вкладений JSON ТРК → пістолети за один лінійний прохід по курсору
+ *
+ * Рядки приходять відсортованими, тому ТРК завершується, щойно змінюється
+ * пара (terminal_id, dispenser_id) — без проміжного групування.
+ * @param query Виконаний запит dispensersWithPumpsSql()
+ * @return Масиви ТРК (з `pumps_info`, якщо є пістолети), згруповані за terminal_id
+ */
+QHash<int, QJsonArray> buildDispensersWithPumps(QSqlQuery &query) {
+    RequestTrace::Scope timing(RequestTrace::Serialize);
+
+    // 🔹 Порядок колонок у dispensersWithPumpsSql()
+    enum Column { TerminalId, DispenserId, ProtocolName, ChannelPort, ChannelSpeed, NetAddress,
+                  PumpId, TankId, FuelShortname };
+
+    QHash<int, QJsonArray> dispensersByTerminal;
+    QJsonObject dispenser;
+    QJsonArray pumps;
+    int currentTerminal = 0;
+    int currentDispenser = 0;
+    bool hasDispenser = false;
+
+    auto finishDispenser = [&]() {
+        if (!hasDispenser) {
+            return;
+        }
+        if (!pumps.isEmpty()) {
+            dispenser["pumps_info"] = pumps;
+        }
+        dispensersByTerminal[currentTerminal].append(dispenser);
+        pumps = QJsonArray();
+        hasDispenser = false;
+    };
+
+    while (query.next()) {
+        const int terminalId = query.value(TerminalId).toInt();
+        const int dispenserId = query.value(DispenserId).toInt();
+
+        if (!hasDispenser || terminalId != currentTerminal || dispenserId != currentDispenser) {
+            finishDispenser();
+            dispenser = QJsonObject();
+            dispenser["dispenser_id"] = dispenserId;
+            dispenser["protocol"] = query.value(ProtocolName).toString();
+            dispenser["port"] = query.value(ChannelPort).toInt();
+            dispenser["speed"] = query.value(ChannelSpeed).toInt();
+            dispenser["address"] = query.value(NetAddress).toInt();
+            currentTerminal = terminalId;
+            currentDispenser = dispenserId;
+            hasDispenser = true;
+        }
+
+        if (!query.value(PumpId).isNull()) {
+            QJsonObject pump;
+            pump["pump_id"] = query.value(PumpId).toInt();
+            pump["tank_id"] = query.value(TankId).toInt();
+            pump["fuel_shortname"] = query.value(FuelShortname).toString();
+            pumps.append(pump);
+        }
+    }
+    finishDispenser();
+
+    return dispensersByTerminal;
+}
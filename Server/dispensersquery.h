@@ -0,0 +1,25 @@
+#ifndef DISPENSERSQUERY_H
+#define DISPENSERSQUERY_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QSqlQuery>
+#include <QString>
+
+/**
+ * @brief Вибірка ТРК з пістолетами з бази клієнта
+ *
+ * Спільна для /terminal_info, /terminal_info/batch та цілі `dispensers_bench`:
+ * один впорядкований запит на АЗС (або на список АЗС через IN (...)) і
+ * побудова вкладеного JSON за один прохід по курсору.
+ */
+
+// 🔹 Firebird обмежує IN (...) 1500 елементами, тому список АЗС ділимо на частини
+constexpr int kInListChunkSize = 500;
+
+qsizetype inListBucket(qsizetype count);
+QString inPlaceholders(qsizetype count);
+QString dispensersWithPumpsSql(const QString &terminalFilter);
+QHash<int, QJsonArray> buildDispensersWithPumps(QSqlQuery &query);
+
+#endif // DISPENSERSQUERY_H
@@ -0,0 +1,171 @@
+#include "healthmonitor.h"
+#include "clientdbpool.h"
+#include "jsonwriter.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QTimer>
+#include <QDebug>
+
+static const QString kCentralProbeConnection = QStringLiteral("health_central");
+
+HealthMonitor::HealthMonitor(const ClientDBParams &central, ClientDBPool *pool, int intervalSec, QObject *parent)
+    : QObject(parent), central(central), pool(pool), intervalSec(intervalSec) {
+    thread.setObjectName("HealthMonitor");
+}
+
+HealthMonitor::~HealthMonitor() {
+    thread.quit();
+    thread.wait();
+}
+
+/**
+ * @brief Запускає потік перевірок: перша перевірка одразу, далі кожні intervalSec секунд
+ */
+void HealthMonitor::start() {
+    if (!isEnabled() || thread.isRunning()) {
+        return;
+    }
+
+    // 🔹 Таймер живе в потоці перевірок, тож і probeAll() виконується там
+    auto *timer = new QTimer();
+    timer->setInterval(intervalSec * 1000);
+    timer->moveToThread(&thread);
+    connect(timer, &QTimer::timeout, timer, [this]() { probeAll(); });
+    connect(&thread, &QThread::started, timer, [this, timer]() {
+        probeAll();
+        timer->start();
+    });
+    // 🔹 Підключення перевірок закриваються в їхньому потоці перед його завершенням
+    connect(&thread, &QThread::finished, timer, [this]() { closeProbeConnections(); }, Qt::DirectConnection);
+    connect(&thread, &QThread::finished, timer, &QObject::deleteLater);
+    thread.start();
+
+    qInfo() << "✅ Фонова перевірка баз кожні" << intervalSec << "с";
+}
+
+/**
+ * @brief Останній знімок перевірок у JSON
+ */
+QByteArray HealthMonitor::snapshot() const {
+    QMutexLocker locker(&mutex);
+    return cached;
+}
+
+/**
+ * @brief Перевіряє одну базу: підключається (якщо ще не підключено) та виконує легкий запит
+ *
+ * Після помилки підключення закривається, щоб наступна перевірка відкрила його заново.
+ */
+HealthMonitor::Probe HealthMonitor::probe(const QString &connectionName, const ClientDBParams &params) {
+    Probe result;
+    QElapsedTimer timer;
+    timer.start();
+    {
+        QSqlDatabase probeDB = QSqlDatabase::contains(connectionName)
+                                   ? QSqlDatabase::database(connectionName, false)
+                                   : QSqlDatabase::addDatabase("QIBASE", connectionName);
+        if (!probeDB.isOpen()) {
+            probeDB.setHostName(params.server);
+            probeDB.setPort(params.port);
+            probeDB.setDatabaseName(params.database);
+            probeDB.setUserName(params.username);
+            probeDB.setPassword(params.password);
+            if (!probeDB.open()) {
+                result.error = probeDB.lastError().text();
+            }
+        }
+
+        if (result.error.isEmpty()) {
+            QSqlQuery query(probeDB);
+            if (query.exec("SELECT 1 FROM RDB$DATABASE")) {
+                result.ok = true;
+            } else {
+                result.error = query.lastError().text();
+                query.finish();
+                probeDB.close();
+            }
+        }
+    }
+    result.latencyMs = double(timer.nsecsElapsed() / 1000) / 1000.0;
+    return result;
+}
+
+/**
+ * @brief Перевіряє всі бази та оновлює знімок
+ */
+void HealthMonitor::probeAll() {
+    const QString checkedAt = QDateTime::currentDateTime().toString(Qt::ISODate);
+
+    auto writeProbe = [&checkedAt](JsonWriter &writer, const Probe &probe) {
+        writer.field("ok", probe.ok).field("latency_ms", probe.latencyMs).field("checked_at", checkedAt);
+        if (!probe.ok) {
+            writer.field("error", probe.error);
+        }
+    };
+
+    const Probe centralProbe = probe(kCentralProbeConnection, central);
+    if (centralProbe.ok != centralAlive.load(std::memory_order_relaxed)) {
+        if (centralProbe.ok) {
+            qInfo() << "✅ Основна база знову доступна";
+        } else {
+            qCritical() << "❌ Основна база недоступна:" << centralProbe.error;
+        }
+    }
+    centralAlive.store(centralProbe.ok, std::memory_order_relaxed);
+
+    struct ClientProbe {
+        QString label;
+        Probe probe;
+        QString breaker;
+    };
+    QList<ClientProbe> clientProbes;
+    bool allClientsOk = true;
+    for (const ClientDBParams &params : pool->knownClients()) {
+        QString &connectionName = connectionNames[params.poolKey()];
+        if (connectionName.isEmpty()) {
+            connectionName = QString("health_%1").arg(connectionNames.size());
+        }
+        const Probe clientProbe = probe(connectionName, params);
+        pool->reportProbe(params, clientProbe.ok);  // 🔹 Успішна перевірка замикає запобіжник пулу
+        clientProbes.append({params.label(), clientProbe, pool->breakerState(params)});
+        allClientsOk = allClientsOk && clientProbe.ok;
+    }
+
+    JsonWriter writer(1024);
+    writer.beginObject()
+        .field("status", !centralProbe.ok ? "error" : allClientsOk ? "ok" : "degraded")
+        .field("probe_interval_sec", intervalSec);
+    writer.key("central_db").beginObject();
+    writeProbe(writer, centralProbe);
+    writer.endObject();
+
+    writer.key("client_dbs").beginArray();
+    for (const ClientProbe &client : clientProbes) {
+        writer.beginObject().field("connection", client.label);
+        writeProbe(writer, client.probe);
+        writer.field("breaker", client.breaker).endObject();
+    }
+    writer.endArray().endObject();
+
+    QByteArray json = writer.take();
+    QMutexLocker locker(&mutex);
+    cached = std::move(json);
+}
+
+/**
+ * @brief Закриває підключення перевірок (викликається в потоці перевірок)
+ */
+void HealthMonitor::closeProbeConnections() {
+    QStringList names = connectionNames.values();
+    names.append(kCentralProbeConnection);
+    for (const QString &name : names) {
+        if (QSqlDatabase::contains(name)) {
+            QSqlDatabase::database(name, false).close();
+            QSqlDatabase::removeDatabase(name);
+        }
+    }
+    connectionNames.clear();
+}
@@ -0,0 +1,57 @@
+#ifndef HEALTHMONITOR_H
+#define HEALTHMONITOR_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QHash>
+#include <QByteArray>
+#include <atomic>
+#include "clientdbparams.h"
+
+class ClientDBPool;
+
+/**
+ * @brief Фонова перевірка основної бази та баз клієнтів для `/status?deep=1`
+ *
+ * Кожні intervalSec секунд окремий потік виконує `SELECT 1 FROM RDB$DATABASE`
+ * на основній базі та на кожній базі клієнта, відомій пулу підключень. Для перевірок
+ * потік тримає власні підключення (вони закріплені за ним, як і всі QSqlDatabase).
+ * Результат одразу серіалізується в JSON, тож `/status?deep=1` лише віддає готовий
+ * знімок і ніколи не чекає на недоступний сервер — навіть коли перевірка зависла
+ * на тайм-ауті TCP, видно час попереднього знімка.
+ */
+class HealthMonitor : public QObject {
+    Q_OBJECT
+public:
+    HealthMonitor(const ClientDBParams &central, ClientDBPool *pool, int intervalSec, QObject *parent = nullptr);
+    ~HealthMonitor();
+
+    void start();
+    bool isEnabled() const { return intervalSec > 0; }
+    QByteArray snapshot() const;  // 🔹 Останній результат у JSON (порожній, поки перевірок не було)
+    bool isCentralAlive() const { return centralAlive.load(std::memory_order_relaxed); }
+
+private:
+    struct Probe {
+        bool ok = false;
+        double latencyMs = 0;
+        QString error;
+    };
+
+    void probeAll();  // 🔹 Виконується в потоці перевірок
+    Probe probe(const QString &connectionName, const ClientDBParams &params);
+    void closeProbeConnections();
+
+    ClientDBParams central;
+    ClientDBPool *pool;
+    int intervalSec;
+    QThread thread;
+    QHash<QString, QString> connectionNames;  // ключ пулу → ім'я підключення перевірки (лише в потоці перевірок)
+
+    mutable QMutex mutex;
+    QByteArray cached;
+    std::atomic<bool> centralAlive{false};
+};
+
+#endif // HEALTHMONITOR_H
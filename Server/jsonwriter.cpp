@@ -0,0 +1,208 @@
+#include "jsonwriter.h"
+#include <QLocale>
+#include <cmath>
+#include <utility>
+
+/**
+ * @brief Конструктор
+ * @param reserveBytes Скільки байтів виділити під буфер одразу
+ */
+JsonWriter::JsonWriter(qsizetype reserveBytes) {
+    out.reserve(reserveBytes);
+}
+
+/**
+ * @brief Ставить кому перед наступним елементом масиву чи об'єкта
+ */
+void JsonWriter::separator() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (firstInScope.isEmpty()) {
+        return;
+    }
+    if (firstInScope.last()) {
+        firstInScope.last() = false;
+    } else {
+        out.append(',');
+    }
+}
+
+JsonWriter &JsonWriter::beginObject() {
+    separator();
+    out.append('{');
+    firstInScope.append(true);
+    return *this;
+}
+
+JsonWriter &JsonWriter::endObject() {
+    Q_ASSERT(!firstInScope.isEmpty() && !afterKey);
+    firstInScope.removeLast();
+    out.append('}');
+    return *this;
+}
+
+JsonWriter &JsonWriter::beginArray() {
+    separator();
+    out.append('[');
+    firstInScope.append(true);
+    return *this;
+}
+
+JsonWriter &JsonWriter::endArray() {
+    Q_ASSERT(!firstInScope.isEmpty() && !afterKey);
+    firstInScope.removeLast();
+    out.append(']');
+    return *this;
+}
+
+/**
+ * @brief Записує ключ об'єкта; наступний виклик value()/begin*() — його значення
+ */
+JsonWriter &JsonWriter::key(const char *name) {
+    Q_ASSERT(!afterKey);
+    separator();
+    writeString(QByteArray::fromRawData(name, qstrlen(name)));
+    out.append(':');
+    afterKey = true;
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(const QString &text) {
+    separator();
+    writeString(text.toUtf8());
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(const char *text) {
+    separator();
+    writeString(QByteArray::fromRawData(text, qstrlen(text)));
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(int number) {
+    separator();
+    out.append(QByteArray::number(number));
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(qint64 number) {
+    separator();
+    out.append(QByteArray::number(number));
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(double number) {
+    // 🔹 JSON не має NaN/Infinity — як і QJsonDocument, пишемо null
+    if (!std::isfinite(number)) {
+        return null();
+    }
+    separator();
+    out.append(QByteArray::number(number, 'g', QLocale::FloatingPointShortest));
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(bool flag) {
+    separator();
+    out.append(flag ? "true" : "false");
+    return *this;
+}
+
+/**
+ * @brief Записує значення колонки QSqlQuery відповідно до його типу
+ */
+JsonWriter &JsonWriter::value(const QVariant &variant) {
+    if (variant.isNull()) {
+        return null();
+    }
+    switch (variant.typeId()) {
+    case QMetaType::Bool:
+        return value(variant.toBool());
+    case QMetaType::Int:
+    case QMetaType::Short:
+    case QMetaType::UInt:
+    case QMetaType::UShort:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+        return value(variant.toLongLong());
+    case QMetaType::Double:
+    case QMetaType::Float:
+        return value(variant.toDouble());
+    default:
+        return value(variant.toString());
+    }
+}
+
+JsonWriter &JsonWriter::null() {
+    separator();
+    out.append("null");
+    return *this;
+}
+
+JsonWriter &JsonWriter::raw(const QByteArray &json) {
+    separator();
+    out.append(json);
+    return *this;
+}
+
+JsonWriter &JsonWriter::lineBreak() {
+    Q_ASSERT(firstInScope.isEmpty());
+    out.append('\n');
+    return *this;
+}
+
+/**
+ * @brief Забирає вже записані байти; стан вкладеності зберігається, буфер лишається виділеним
+ */
+QByteArray JsonWriter::flush() {
+    QByteArray chunk(out.constData(), out.size());
+    out.truncate(0);
+    return chunk;
+}
+
+/**
+ * @brief Забирає накопичений JSON
+ */
+QByteArray JsonWriter::take() {
+    firstInScope.clear();
+    afterKey = false;
+    return std::exchange(out, QByteArray());
+}
+
+/**
+ * @brief Записує рядок у лапках, екрануючи лапки, зворотну косу риску та керуючі символи
+ *
+ * Байти UTF-8 багатобайтових символів ≥ 0x80, тож екранування побайтно безпечне.
+ */
+void JsonWriter::writeString(const QByteArray &utf8) {
+    static const char hex[] = "0123456789abcdef";
+
+    out.append('"');
+    const char *begin = utf8.constData();
+    const char *const end = begin + utf8.size();
+    const char *run = begin;  // 🔹 Початок ділянки без екранування — копіюємо її одним append
+    for (const char *p = begin; p != end; ++p) {
+        const uchar c = uchar(*p);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.append(run, p - run);
+        run = p + 1;
+        switch (c) {
+        case '"':  out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\b': out.append("\\b"); break;
+        case '\f': out.append("\\f"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        case '\t': out.append("\\t"); break;
+        default: {
+            const char escaped[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+            out.append(escaped, sizeof(escaped));
+        }
+        }
+    }
+    out.append(run, end - run);
+    out.append('"');
+}
@@ -0,0 +1,54 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <QVarLengthArray>
+
+/**
+ * @brief Потоковий запис компактного JSON у заздалегідь виділений буфер
+ *
+ * На відміну від QJsonArray/QJsonObject + QJsonDocument::toJson(), рядки з курсора
+ * QSqlQuery записуються одразу в QByteArray без проміжного дерева та повторного
+ * копіювання. Ключі пишуться в порядку виклику, рядки — в UTF-8 з екрануванням
+ * за RFC 8259. Коректність вкладеності перевіряється лише Q_ASSERT.
+ */
+class JsonWriter {
+public:
+    explicit JsonWriter(qsizetype reserveBytes = 4096);
+
+    JsonWriter &beginObject();
+    JsonWriter &endObject();
+    JsonWriter &beginArray();
+    JsonWriter &endArray();
+    JsonWriter &key(const char *name);
+
+    JsonWriter &value(const QString &text);
+    JsonWriter &value(const char *text);
+    JsonWriter &value(int number);
+    JsonWriter &value(qint64 number);
+    JsonWriter &value(double number);
+    JsonWriter &value(bool flag);
+    JsonWriter &value(const QVariant &variant);  // 🔹 Значення колонки QSqlQuery; NULL → null
+    JsonWriter &null();
+    JsonWriter &raw(const QByteArray &json);     // 🔹 Готовий JSON-фрагмент без перевірки
+    JsonWriter &lineBreak();                     // 🔹 Розділювач записів NDJSON (лише поза масивами/об'єктами)
+
+    template <typename T>
+    JsonWriter &field(const char *name, const T &v) { return key(name).value(v); }
+
+    const QByteArray &buffer() const { return out; }
+    QByteArray take();   // 🔹 Забирає буфер; писати далі можна лише з нуля
+    QByteArray flush();  // 🔹 Забирає вже записане, продовжуючи той самий документ (для передачі частинами)
+
+private:
+    void separator();
+    void writeString(const QByteArray &utf8);
+
+    QByteArray out;
+    QVarLengthArray<bool, 16> firstInScope;  // 🔹 Чи ще не було елементів на кожному рівні вкладеності
+    bool afterKey = false;
+};
+
+#endif // JSONWRITER_H
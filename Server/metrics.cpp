@@ -0,0 +1,152 @@
+#include "metrics.h"
+#include <QHash>
+
+// 🔹 Межі кошиків у секундах: від 1 мс до 10 с
+const double LatencyHistogram::kBoundsSec[kBounds] = {
+    0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0};
+
+/**
+ * @brief Додає спостереження в гістограму
+ */
+void LatencyHistogram::observe(qint64 nsecs) {
+    const double sec = double(nsecs) / 1e9;
+    int bucket = 0;
+    while (bucket < kBounds && sec > kBoundsSec[bucket]) {
+        ++bucket;
+    }
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sumNs.fetch_add(quint64(qMax<qint64>(0, nsecs)), std::memory_order_relaxed);
+}
+
+/**
+ * @brief Пише `_bucket` (накопичувально), `_sum` та `_count` у текстовому форматі Prometheus
+ * @param labels Мітки без дужок, наприклад `route="/clients"`
+ */
+void LatencyHistogram::render(QByteArray &out, const QByteArray &name, const QByteArray &labels) const {
+    const QByteArray prefix = labels.isEmpty() ? QByteArray() : labels + ',';
+    quint64 cumulative = 0;
+    for (int i = 0; i <= kBounds; ++i) {
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+        const QByteArray le = i < kBounds ? QByteArray::number(kBoundsSec[i]) : QByteArray("+Inf");
+        out += name + "_bucket{" + prefix + "le=\"" + le + "\"} " + QByteArray::number(cumulative) + '\n';
+    }
+    const QByteArray braces = labels.isEmpty() ? QByteArray() : '{' + labels + '}';
+    out += name + "_sum" + braces + ' ' + QByteArray::number(double(sumNs.load(std::memory_order_relaxed)) / 1e9) + '\n';
+    out += name + "_count" + braces + ' ' + QByteArray::number(count.load(std::memory_order_relaxed)) + '\n';
+}
+
+/**
+ * @brief Реєструє маршрут; викликається лише до запуску сервера
+ */
+void Metrics::registerRoute(const QString &route) {
+    routes.try_emplace(route, std::make_unique<RouteMetrics>());
+}
+
+/**
+ * @brief Лічильники маршруту за шляхом запиту; `/clients/<id>` зводиться до одного маршруту
+ */
+Metrics::RouteMetrics *Metrics::routeMetrics(const QString &path) const {
+    auto it = routes.find(path);
+    if (it == routes.end() && path.startsWith("/clients/")) {
+        it = routes.find(QStringLiteral("/clients/<id>"));
+    }
+    return it != routes.end() ? it->second.get() : nullptr;
+}
+
+/**
+ * @brief Рахує запит, помилку та його тривалість
+ */
+void Metrics::observeRequest(const QString &path, bool error, qint64 nsecs) {
+    RouteMetrics *route = routeMetrics(path);
+    if (!route) {
+        return;
+    }
+    route->requests.fetch_add(1, std::memory_order_relaxed);
+    if (error) {
+        route->errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    route->latency.observe(nsecs);
+}
+
+/**
+ * @brief Гістограма бази клієнта; створюється при першому зверненні
+ */
+LatencyHistogram *Metrics::clientHistogram(const QString &client) {
+    thread_local QHash<QString, LatencyHistogram *> cache;
+    if (LatencyHistogram *cached = cache.value(client)) {
+        return cached;
+    }
+
+    LatencyHistogram *histogram = nullptr;
+    {
+        QReadLocker locker(&clientsLock);
+        auto it = clients.find(client);
+        if (it != clients.end()) {
+            histogram = it->second.get();
+        }
+    }
+    if (!histogram) {
+        QWriteLocker locker(&clientsLock);
+        auto &slot = clients[client];
+        if (!slot) {
+            slot = std::make_unique<LatencyHistogram>();
+        }
+        histogram = slot.get();
+    }
+    cache.insert(client, histogram);
+    return histogram;
+}
+
+/**
+ * @brief Рахує тривалість запиту до бази клієнта
+ * @param client Мітка підключення (ClientDBParams::label)
+ */
+void Metrics::observeClientQuery(const QString &client, qint64 nsecs) {
+    clientHistogram(client)->observe(nsecs);
+}
+
+/**
+ * @brief Екранує значення мітки: зворотна коса риска, лапки, перенесення рядка
+ */
+QByteArray Metrics::label(const QString &value) {
+    QByteArray escaped = value.toUtf8();
+    escaped.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return escaped;
+}
+
+/**
+ * @brief Метрики маршрутів та запитів до баз клієнтів у текстовому форматі Prometheus
+ */
+QByteArray Metrics::render() const {
+    QByteArray out;
+    out.reserve(16 * 1024);
+
+    out += "# HELP palantir_http_requests_total Кількість оброблених запитів\n"
+           "# TYPE palantir_http_requests_total counter\n";
+    for (const auto &[route, m] : routes) {
+        out += "palantir_http_requests_total{route=\"" + label(route) + "\"} "
+               + QByteArray::number(m->requests.load(std::memory_order_relaxed)) + '\n';
+    }
+
+    out += "# HELP palantir_http_request_errors_total Кількість запитів, що завершились помилкою\n"
+           "# TYPE palantir_http_request_errors_total counter\n";
+    for (const auto &[route, m] : routes) {
+        out += "palantir_http_request_errors_total{route=\"" + label(route) + "\"} "
+               + QByteArray::number(m->errors.load(std::memory_order_relaxed)) + '\n';
+    }
+
+    out += "# HELP palantir_http_request_duration_seconds Тривалість обробки запиту\n"
+           "# TYPE palantir_http_request_duration_seconds histogram\n";
+    for (const auto &[route, m] : routes) {
+        m->latency.render(out, "palantir_http_request_duration_seconds", "route=\"" + label(route) + '"');
+    }
+
+    out += "# HELP palantir_client_db_query_duration_seconds Тривалість запитів до бази клієнта\n"
+           "# TYPE palantir_client_db_query_duration_seconds histogram\n";
+    QReadLocker locker(&clientsLock);
+    for (const auto &[client, histogram] : clients) {
+        histogram->render(out, "palantir_client_db_query_duration_seconds", "client=\"" + label(client) + '"');
+    }
+    return out;
+}
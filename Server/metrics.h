@@ -0,0 +1,62 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QByteArray>
+#include <QString>
+#include <QReadWriteLock>
+#include <atomic>
+#include <map>
+#include <memory>
+
+/**
+ * @brief Гістограма затримок з фіксованими межами кошиків (як у Prometheus)
+ *
+ * observe() — лише кілька relaxed atomic-інкрементів, без блокувань.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kBounds = 13;
+    static const double kBoundsSec[kBounds];
+
+    void observe(qint64 nsecs);
+    void render(QByteArray &out, const QByteArray &name, const QByteArray &labels) const;
+
+private:
+    std::atomic<quint64> buckets[kBounds + 1] = {};  // 🔹 Останній — +Inf
+    std::atomic<quint64> count{0};
+    std::atomic<quint64> sumNs{0};
+};
+
+/**
+ * @brief Лічильники запитів для `/metrics`
+ *
+ * Маршрути реєструються до запуску сервера, тому пошук лічильників маршруту
+ * не потребує блокувань. Гістограми баз клієнтів створюються при першому
+ * запиті до бази під блокуванням, а далі кожен потік бере вказівник
+ * зі свого thread_local кешу.
+ */
+class Metrics {
+public:
+    void registerRoute(const QString &route);
+    void observeRequest(const QString &path, bool error, qint64 nsecs);
+    void observeClientQuery(const QString &client, qint64 nsecs);
+    QByteArray render() const;
+
+    static QByteArray label(const QString &value);  // 🔹 Екранує значення мітки Prometheus
+
+private:
+    struct RouteMetrics {
+        std::atomic<quint64> requests{0};
+        std::atomic<quint64> errors{0};
+        LatencyHistogram latency;
+    };
+
+    RouteMetrics *routeMetrics(const QString &path) const;
+    LatencyHistogram *clientHistogram(const QString &client);
+
+    std::map<QString, std::unique_ptr<RouteMetrics>> routes;  // 🔹 Не змінюється після запуску
+    mutable QReadWriteLock clientsLock;
+    std::map<QString, std::unique_ptr<LatencyHistogram>> clients;
+};
+
+#endif // METRICS_H
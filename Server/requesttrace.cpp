@@ -0,0 +1,82 @@
+#include "requesttrace.h"
+#include "jsonwriter.h"
+#include <QDateTime>
+#include <QAtomicInteger>
+
+Q_LOGGING_CATEGORY(lcRequest, "palantir.request")
+
+static thread_local RequestTrace *currentTrace = nullptr;
+
+/**
+ * @brief Починає трасу запиту і робить її поточною для потоку
+ * @param requestId Ідентифікатор запиту (з X-Request-Id або згенерований)
+ * @param route Шлях запиту
+ * @param query Параметри запиту — з них беруться client_id та terminal_id
+ */
+RequestTrace::RequestTrace(const QByteArray &requestId, const QString &route, const QUrlQuery &query)
+    : requestId(requestId), route(route), previous(currentTrace) {
+    bool ok = false;
+    const int client = query.queryItemValue("client_id").toInt(&ok);
+    if (ok) {
+        clientId = client;
+    }
+    const int terminal = query.queryItemValue("terminal_id").toInt(&ok);
+    if (ok) {
+        terminalId = terminal;
+    }
+    total.start();
+    currentTrace = this;
+}
+
+RequestTrace::~RequestTrace() {
+    currentTrace = previous;
+}
+
+RequestTrace *RequestTrace::current() {
+    return currentTrace;
+}
+
+/**
+ * @brief Генерує id запиту: мітка запуску процесу + лічильник
+ */
+QByteArray RequestTrace::nextRequestId() {
+    static const QByteArray prefix = QByteArray::number(QDateTime::currentSecsSinceEpoch() & 0xFFFFFF, 16);
+    static QAtomicInteger<quint64> counter;
+    return prefix + '-' + QByteArray::number(counter.fetchAndAddRelaxed(1) + 1, 16);
+}
+
+/**
+ * @brief Пише підсумок запиту в лог одним JSON-рядком
+ * @param status HTTP-статус відповіді
+ * @param responseBytes Розмір тіла відповіді
+ */
+void RequestTrace::finish(int status, qint64 responseBytes) {
+    if (finished || !lcRequest().isInfoEnabled()) {
+        return;
+    }
+    finished = true;
+
+    auto ms = [](qint64 ns) { return double(ns / 1000) / 1000.0; };
+
+    JsonWriter writer(256);
+    writer.beginObject()
+        .field("event", "request")
+        .field("request_id", QString::fromLatin1(requestId))
+        .field("route", route);
+    if (clientId >= 0) {
+        writer.field("client_id", clientId);
+    }
+    if (terminalId >= 0) {
+        writer.field("terminal_id", terminalId);
+    }
+    writer.field("status", status)
+        .field("central_db_ms", ms(phaseNs[CentralDb]))
+        .field("client_connect_ms", ms(phaseNs[ClientConnect]))
+        .field("client_query_ms", ms(phaseNs[ClientQuery]))
+        .field("serialize_ms", ms(phaseNs[Serialize]))
+        .field("total_ms", ms(total.nsecsElapsed()))
+        .field("response_bytes", responseBytes)
+        .endObject();
+
+    qCInfo(lcRequest).noquote() << QString::fromUtf8(writer.take());
+}
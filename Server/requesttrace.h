@@ -0,0 +1,80 @@
+#ifndef REQUESTTRACE_H
+#define REQUESTTRACE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QUrlQuery>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(lcRequest)
+
+/**
+ * @brief Хронометраж одного запиту для структурованого логу
+ *
+ * Обробник створює трасу в робочому потоці; поки вона жива, RequestTrace::Scope
+ * у будь-якій допоміжній функції цього потоку додає свій час до відповідної фази.
+ * finish() пише в категорію `palantir.request` один JSON-об'єкт з id запиту,
+ * маршрутом, client_id/terminal_id, часом фаз і розміром відповіді.
+ */
+class RequestTrace {
+public:
+    enum Phase {
+        CentralDb,      // запити до основної бази
+        ClientConnect,  // отримання підключення до бази клієнта з пулу
+        ClientQuery,    // запити до бази клієнта
+        Serialize,      // вибірка рядків та формування JSON
+        PhaseCount
+    };
+
+    RequestTrace(const QByteArray &requestId, const QString &route, const QUrlQuery &query);
+    ~RequestTrace();
+    RequestTrace(const RequestTrace &) = delete;
+    RequestTrace &operator=(const RequestTrace &) = delete;
+
+    static RequestTrace *current();  // 🔹 Траса запиту, що обробляється в цьому потоці
+    static QByteArray nextRequestId();
+
+    void setClientId(int id) { clientId = id; }
+    void markTimedOut() { timedOut = true; }  // 🔹 Запит до бази клієнта перервано за тайм-аутом
+    bool isTimedOut() const { return timedOut; }
+    void add(Phase phase, qint64 nsecs) { phaseNs[phase] += nsecs; }
+    void finish(int status, qint64 responseBytes);
+
+    /**
+     * @brief Додає час життя області до фази поточного запиту (якщо він є)
+     */
+    class Scope {
+    public:
+        explicit Scope(Phase phase) : phase(phase), trace(RequestTrace::current()) {
+            if (trace) {
+                timer.start();
+            }
+        }
+        ~Scope() {
+            if (trace) {
+                trace->add(phase, timer.nsecsElapsed());
+            }
+        }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        Phase phase;
+        RequestTrace *trace;
+        QElapsedTimer timer;
+    };
+
+private:
+    QByteArray requestId;
+    QString route;
+    int clientId = -1;
+    int terminalId = -1;
+    qint64 phaseNs[PhaseCount] = {};
+    QElapsedTimer total;
+    RequestTrace *previous;
+    bool finished = false;
+    bool timedOut = false;
+};
+
+#endif // REQUESTTRACE_H
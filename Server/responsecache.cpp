@@ -0,0 +1,135 @@
+#include "responsecache.h"
+#include <QJsonArray>
+#include <algorithm>
+
+/**
+ * @brief Конструктор кешу відповідей
+ * @param maxEntries Максимальна кількість записів
+ * @param maxBytes Максимальний сумарний розмір тіл відповідей
+ */
+ResponseCache::ResponseCache(int maxEntries, qint64 maxBytes)
+    : maxEntries(qMax(1, maxEntries)), maxBytes(qMax<qint64>(1, maxBytes)) {}
+
+/**
+ * @brief Задає час життя відповідей маршруту; 0 вимикає кешування маршруту
+ */
+void ResponseCache::setRouteTtl(const QString &route, int ttlSec) {
+    QMutexLocker locker(&mutex);
+    routes[route].ttlSec = ttlSec;
+}
+
+/**
+ * @brief Будує ключ кешу: маршрут і відсортовані параметри, щоб порядок параметрів не впливав
+ */
+QString ResponseCache::makeKey(const QString &route, const QUrlQuery &query) {
+    auto items = query.queryItems(QUrl::FullyDecoded);
+    std::sort(items.begin(), items.end());
+
+    QString key = route;
+    for (const auto &item : std::as_const(items)) {
+        key += '&' + item.first + '=' + item.second;
+    }
+    return key;
+}
+
+/**
+ * @brief Повертає тіло відповіді з кешу, якщо воно ще не застаріло
+ */
+std::optional<ResponseCache::CachedResponse> ResponseCache::get(const QString &route, const QUrlQuery &query) {
+    const QString key = makeKey(route, query);
+
+    QMutexLocker locker(&mutex);
+    RouteStats &routeStats = routes[route];
+    if (routeStats.ttlSec <= 0) {
+        return std::nullopt;
+    }
+
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        routeStats.misses++;
+        return std::nullopt;
+    }
+    if (it->expires.hasExpired()) {
+        removeEntry(it);
+        routeStats.misses++;
+        return std::nullopt;
+    }
+
+    // 🔹 Переносимо ключ на початок списку LRU
+    lru.splice(lru.begin(), lru, it->lruPos);
+    routeStats.hits++;
+    return it->response;
+}
+
+/**
+ * @brief Зберігає тіло відповіді та витісняє найстаріші записи при перевищенні лімітів
+ */
+void ResponseCache::put(const QString &route, const QUrlQuery &query, const CachedResponse &response) {
+    const QString key = makeKey(route, query);
+
+    QMutexLocker locker(&mutex);
+    const int ttlSec = routes.value(route).ttlSec;
+    if (ttlSec <= 0 || response.size() > maxBytes) {
+        return;
+    }
+
+    auto existing = entries.find(key);
+    if (existing != entries.end()) {
+        removeEntry(existing);
+    }
+
+    lru.push_front(key);
+    Entry entry;
+    entry.route = route;
+    entry.response = response;
+    entry.expires = QDeadlineTimer(qint64(ttlSec) * 1000);
+    entry.lruPos = lru.begin();
+    entries.insert(key, entry);
+    totalBytes += response.size();
+
+    while (entries.size() > maxEntries || totalBytes > maxBytes) {
+        removeEntry(entries.find(lru.back()));
+        evictions++;
+    }
+}
+
+void ResponseCache::clear() {
+    QMutexLocker locker(&mutex);
+    entries.clear();
+    lru.clear();
+    totalBytes = 0;
+}
+
+QJsonObject ResponseCache::stats() const {
+    QMutexLocker locker(&mutex);
+
+    QJsonObject routesObj;
+    quint64 hits = 0;
+    quint64 misses = 0;
+    for (auto it = routes.constBegin(); it != routes.constEnd(); ++it) {
+        QJsonObject obj;
+        obj["ttl_sec"] = it->ttlSec;
+        obj["hits"] = qint64(it->hits);
+        obj["misses"] = qint64(it->misses);
+        routesObj[it.key()] = obj;
+        hits += it->hits;
+        misses += it->misses;
+    }
+
+    QJsonObject result;
+    result["entries"] = int(entries.size());
+    result["bytes"] = totalBytes;
+    result["max_entries"] = maxEntries;
+    result["max_bytes"] = maxBytes;
+    result["hits"] = qint64(hits);
+    result["misses"] = qint64(misses);
+    result["evictions"] = qint64(evictions);
+    result["routes"] = routesObj;
+    return result;
+}
+
+void ResponseCache::removeEntry(QHash<QString, Entry>::iterator it) {
+    totalBytes -= it->response.size();
+    lru.erase(it->lruPos);
+    entries.erase(it);
+}
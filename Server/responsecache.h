@@ -0,0 +1,67 @@
+#ifndef RESPONSECACHE_H
+#define RESPONSECACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QUrlQuery>
+#include <QDeadlineTimer>
+#include <QJsonObject>
+#include <list>
+#include <optional>
+
+/**
+ * @brief Кеш готових JSON-відповідей для маршрутів зі статичною конфігурацією АЗС
+ *
+ * Ключ — маршрут + відсортовані параметри запиту, значення — серіалізоване тіло
+ * разом з його ETag та gzip-версією, щоб повторні влучання не хешували і не стискали тіло знову.
+ * Час життя задається окремо для кожного маршруту; при перевищенні maxEntries
+ * або maxBytes витісняються записи, до яких найдовше не звертались (LRU).
+ */
+class ResponseCache {
+public:
+    struct CachedResponse {
+        QByteArray body;
+        QByteArray etag;
+        QByteArray gzipped;  // тіло, заздалегідь стиснене gzip (порожнє, якщо менше порогу стиснення)
+
+        qint64 size() const { return body.size() + gzipped.size(); }
+    };
+
+    ResponseCache(int maxEntries, qint64 maxBytes);
+
+    void setRouteTtl(const QString &route, int ttlSec);
+    std::optional<CachedResponse> get(const QString &route, const QUrlQuery &query);
+    void put(const QString &route, const QUrlQuery &query, const CachedResponse &response);
+    void clear();
+    QJsonObject stats() const;
+
+    static QString makeKey(const QString &route, const QUrlQuery &query);
+
+private:
+    struct Entry {
+        QString route;
+        CachedResponse response;
+        QDeadlineTimer expires;
+        std::list<QString>::iterator lruPos;
+    };
+
+    struct RouteStats {
+        int ttlSec = 0;
+        quint64 hits = 0;
+        quint64 misses = 0;
+    };
+
+    void removeEntry(QHash<QString, Entry>::iterator it);
+
+    int maxEntries;
+    qint64 maxBytes;
+    qint64 totalBytes = 0;
+    quint64 evictions = 0;
+
+    mutable QMutex mutex;
+    QHash<QString, Entry> entries;
+    std::list<QString> lru;  // на початку — найсвіжіші ключі
+    QHash<QString, RouteStats> routes;
+};
+
+#endif // RESPONSECACHE_H
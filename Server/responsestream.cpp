@@ -0,0 +1,196 @@
+#include "responsestream.h"
+#include <QDeadlineTimer>
+#include <QDebug>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+#include <QHttpHeaders>
+#endif
+
+// 🔹 Скільки байтів відповіді (черга потоку сервера + буфер сокета) може не піти в мережу, поки write() не почне чекати
+static constexpr qint64 kMaxInFlightBytes = 256 * 1024;
+// 🔹 Скільки чекати на місце в буфері, перш ніж перервати передачу
+static constexpr qint64 kStallTimeoutMs = 30000;
+
+/**
+ * @brief Конструктор (у потоці сервера)
+ * @param context Об'єкт у потоці сервера, через чергу якого пишемо у відповідь
+ * @param socket З'єднання запиту: за ним рахуються невідправлені байти і через нього
+ *        обривається перервана передача; nullptr — враховується лише черга потоку сервера
+ * @param responder Відповідач QHttpServer для цього запиту
+ * @param contentType Тип тіла потокової відповіді
+ * @param cacheControl Значення заголовка Cache-Control
+ * @param requestId Значення заголовка X-Request-Id
+ */
+ResponseStream::ResponseStream(QObject *context, QTcpSocket *socket, QHttpServerResponder &&responder,
+                               const QByteArray &contentType, const QByteArray &cacheControl, const QByteArray &requestId)
+    : context(context), socket(socket), responder(std::make_shared<QHttpServerResponder>(std::move(responder))),
+      contentType(contentType), cacheControl(cacheControl), requestId(requestId) {
+    if (!socket) {
+        return;
+    }
+    // 🔹 Обидва обробники виконуються в потоці сокета (потоці сервера), поки він живий
+    writtenConnection = QObject::connect(socket, &QIODevice::bytesWritten, socket, [inFlight = inFlight, socket]() {
+        QMutexLocker locker(&inFlight->mutex);
+        inFlight->unsent = socket->bytesToWrite();
+        inFlight->drained.wakeAll();
+    });
+    closedConnection = QObject::connect(socket, &QAbstractSocket::disconnected, socket, [inFlight = inFlight]() {
+        QMutexLocker locker(&inFlight->mutex);
+        inFlight->closed = true;
+        inFlight->drained.wakeAll();
+    });
+}
+
+ResponseStream::~ResponseStream() {
+    QObject::disconnect(writtenConnection);
+    QObject::disconnect(closedConnection);
+}
+
+/**
+ * @brief Виконує дію з відповідачем у потоці сервера
+ */
+void ResponseStream::post(std::function<void(QHttpServerResponder &)> action) {
+    QMetaObject::invokeMethod(context, [responder = responder, action = std::move(action)]() {
+        action(*responder);
+    }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Резервує місце для частини, за потреби чекаючи, поки клієнт забере вже записане
+ *
+ * Частина, більша за весь ліміт, проходить, коли все попереднє вже відправлено.
+ * @return false, якщо клієнт закрив з'єднання або місце не звільнилося за kStallTimeoutMs
+ */
+bool ResponseStream::reserve(qsizetype size) {
+    QMutexLocker locker(&inFlight->mutex);
+    QDeadlineTimer deadline(kStallTimeoutMs);
+    while (!inFlight->closed) {
+        const qint64 pending = inFlight->queued + inFlight->unsent;
+        if (pending == 0 || pending + size <= kMaxInFlightBytes) {
+            inFlight->queued += size;
+            return true;
+        }
+        if (!inFlight->drained.wait(&inFlight->mutex, deadline)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Обриває з'єднання після початку chunked-тіла: без завершального chunk клієнт бачить невдалу передачу
+ *
+ * Якщо сокет не знайдено, тіло просто не завершується.
+ */
+void ResponseStream::abortConnection() {
+    aborted = true;
+    failed = true;
+    post([socket = socket](QHttpServerResponder &) {
+        if (socket) {
+            socket->abort();
+        }
+    });
+}
+
+/**
+ * @brief Відправляє готову відповідь замість потокової
+ */
+void ResponseStream::send(QHttpServerResponse &&response) {
+    status = int(response.statusCode());
+    bytes = response.data().size();
+    failed = status >= 400 || response.data().startsWith(R"({"error")");
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    QHttpHeaders headers = response.headers();
+    headers.append("X-Request-Id", requestId);
+    response.setHeaders(std::move(headers));
+#else
+    response.addHeader("X-Request-Id", requestId);
+#endif
+    auto shared = std::make_shared<QHttpServerResponse>(std::move(response));
+    post([shared](QHttpServerResponder &r) { r.sendResponse(*shared); });
+}
+
+void ResponseStream::begin() {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    QHttpHeaders headers;
+    headers.append(QHttpHeaders::WellKnownHeader::ContentType, contentType);
+    headers.append(QHttpHeaders::WellKnownHeader::CacheControl, cacheControl);
+    headers.append("X-Request-Id", requestId);
+    post([headers](QHttpServerResponder &r) { r.writeBeginChunked(headers); });
+#endif
+}
+
+bool ResponseStream::write(const QByteArray &chunk) {
+    if (aborted) {
+        return false;
+    }
+    if (chunk.isEmpty()) {
+        return true;
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    if (!reserve(chunk.size())) {
+        qWarning() << "⚠️ Клієнт закрив з'єднання або не забирає відповідь" << kStallTimeoutMs
+                   << "мс, передачу перервано; id =" << requestId;
+        abortConnection();
+        return false;
+    }
+    bytes += chunk.size();
+
+    // 🔹 Частина виходить з черги, коли дію виконано або відкинуто (знищено об'єкт context)
+    struct Reservation {
+        Reservation(std::shared_ptr<InFlight> inFlight, qsizetype size) : inFlight(std::move(inFlight)), size(size) {}
+        ~Reservation() {
+            QMutexLocker locker(&inFlight->mutex);
+            inFlight->queued -= size;
+            inFlight->drained.wakeAll();
+        }
+        std::shared_ptr<InFlight> inFlight;
+        qsizetype size;
+    };
+    auto reservation = std::make_shared<Reservation>(inFlight, chunk.size());
+    post([chunk, reservation, socket = socket](QHttpServerResponder &r) {
+        r.writeChunk(chunk);
+        // 🔹 Записане лягло в буфер сокета — далі його відпускає лише bytesWritten
+        if (socket) {
+            QMutexLocker locker(&reservation->inFlight->mutex);
+            reservation->inFlight->unsent = socket->bytesToWrite();
+        }
+    });
+#else
+    bytes += chunk.size();
+    buffered.append(chunk);
+#endif
+    return true;
+}
+
+void ResponseStream::end() {
+    if (aborted) {
+        return;
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    post([](QHttpServerResponder &r) { r.writeEndChunked(QByteArray()); });
+#else
+    QHttpServerResponse response(contentType, buffered);
+    response.addHeader("Cache-Control", cacheControl);
+    buffered.clear();
+    send(std::move(response));
+#endif
+}
+
+/**
+ * @brief Завершує потокову відповідь помилкою, що сталася вже після begin()
+ *
+ * На Qt 6.8+ статус 200 і частина тіла вже могли піти, тому з'єднання обривається;
+ * на старіших версіях тіло ще в буфері, і замість нього відправляється error.
+ */
+void ResponseStream::fail(QHttpServerResponse &&error) {
+    if (aborted) {
+        return;
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    Q_UNUSED(error);
+    abortConnection();
+#else
+    buffered.clear();
+    send(std::move(error));
+#endif
+}
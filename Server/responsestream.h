@@ -0,0 +1,79 @@
+#ifndef RESPONSESTREAM_H
+#define RESPONSESTREAM_H
+
+#include <QObject>
+#include <QPointer>
+#include <QTcpSocket>
+#include <QHttpServerResponder>
+#include <QHttpServerResponse>
+#include <QByteArray>
+#include <QMutex>
+#include <QWaitCondition>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief Відповідь, яку робочий потік віддає частинами
+ *
+ * QHttpServerResponder прив'язаний до сокета в потоці сервера, тому кожна дія
+ * ставиться в чергу подій context і виконується там у порядку виклику.
+ * На Qt 6.8+ тіло йде з `Transfer-Encoding: chunked` одразу по мірі запису;
+ * на старіших версіях частини накопичуються і відправляються однією відповіддю в end().
+ *
+ * Частини в черзі потоку сервера разом з ще не відправленими байтами сокета обмежені
+ * за сумарним розміром: якщо клієнт читає повільно, write() чекає, поки буфер звільниться,
+ * замість того щоб тримати в пам'яті весь список. Якщо місця немає довше тайм-ауту або
+ * клієнт закрив з'єднання, передача переривається: з'єднання обривається без завершального
+ * chunk, і клієнт бачить невдалу передачу, а не обрізане тіло.
+ */
+class ResponseStream {
+public:
+    ResponseStream(QObject *context, QTcpSocket *socket, QHttpServerResponder &&responder,
+                   const QByteArray &contentType, const QByteArray &cacheControl, const QByteArray &requestId);
+    ~ResponseStream();
+    ResponseStream(const ResponseStream &) = delete;
+    ResponseStream &operator=(const ResponseStream &) = delete;
+
+    void send(QHttpServerResponse &&response);  // 🔹 Звичайна відповідь цілком (зокрема помилка)
+    void begin();                               // 🔹 Статус 200 та заголовки
+    bool write(const QByteArray &chunk);        // 🔹 false — передачу перервано, писати далі марно
+    void end();
+    void fail(QHttpServerResponse &&error);     // 🔹 Помилка посеред запису: обрив з'єднання або error, якщо тіло ще не пішло
+
+    int statusCode() const { return status; }
+    qint64 bytesWritten() const { return bytes; }
+    bool isError() const { return failed; }  // 🔹 Відправлено помилку (4xx/5xx або `{"error": ...}`)
+
+private:
+    // 🔹 Байти відповіді, що ще не пішли в мережу
+    struct InFlight {
+        QMutex mutex;
+        QWaitCondition drained;
+        qint64 queued = 0;    // частини в черзі потоку сервера
+        qint64 unsent = 0;    // QTcpSocket::bytesToWrite() після останнього запису чи відправки
+        bool closed = false;  // клієнт закрив з'єднання
+    };
+
+    void post(std::function<void(QHttpServerResponder &)> action);
+    bool reserve(qsizetype size);
+    void abortConnection();
+
+    QObject *context;
+    QPointer<QTcpSocket> socket;  // 🔹 З'єднання запиту; nullptr, якщо його не знайдено
+    QMetaObject::Connection writtenConnection;
+    QMetaObject::Connection closedConnection;
+    std::shared_ptr<QHttpServerResponder> responder;
+    QByteArray contentType;
+    QByteArray cacheControl;
+    QByteArray requestId;
+    int status = 200;
+    qint64 bytes = 0;
+    bool failed = false;
+    bool aborted = false;  // 🔹 Передачу перервано — решта тіла відкидається, end() нічого не робить
+    std::shared_ptr<InFlight> inFlight = std::make_shared<InFlight>();
+#if QT_VERSION < QT_VERSION_CHECK(6, 8, 0)
+    QByteArray buffered;
+#endif
+};
+
+#endif // RESPONSESTREAM_H
@@ -1,25 +1,191 @@
 
 #include "server.h"
 #include "criptpass.h"
+#include "jsonwriter.h"
+#include "responsestream.h"
+#include "requesttrace.h"
+#include "metrics.h"
+#include "compression.h"
+#include "aesbackend.h"
+#include "dispensersquery.h"
 #include <QDebug>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QSqlError>
 #include <QByteArray>
+#include <QThread>
+#include <QPromise>
+#include <QCryptographicHash>
+#include <QSet>
+#include <QTimer>
+#include <atomic>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QTcpSocket>
+#include <QtConcurrent/QtConcurrentRun>
+#include <cmath>
+#include <limits>
+
+
+
+
+// 🔹 Початковий розмір буфера для списків /clients та /azs_list — щоб уникнути частих перевиділень
+static constexpr qsizetype kListReserveBytes = 16 * 1024;
+// 🔹 Розмір частини потокової відповіді
+static constexpr qsizetype kStreamChunkBytes = 16 * 1024;
+// 🔹 Найбільший явний список terminal_ids у /terminal_info/batch (для всіх АЗС клієнта є "all")
+static constexpr qsizetype kMaxBatchTerminals = 2000;
 
+/**
+ * @brief Виконує підготовлений запит, зараховуючи час до фази поточного запиту
+ */
+static bool execTimed(QSqlQuery &query, RequestTrace::Phase phase) {
+    RequestTrace::Scope timing(phase);
+    return query.exec();
+}
+
+/**
+ * @brief Позначає запит як перерваний за тайм-аутом, якщо помилка запиту до бази клієнта — тайм-аут
+ */
+static void noteClientTimeout(const QSqlQuery &query) {
+    // 🔹 Firebird 4+ перериває запит за STATEMENT TIMEOUT з повідомленням "... timeout ..."
+    if (query.lastError().text().contains("timeout", Qt::CaseInsensitive)) {
+        if (RequestTrace *trace = RequestTrace::current()) {
+            trace->markTimedOut();
+        }
+    }
+}
+
+/**
+ * @brief Виконує підготовлений запит до бази клієнта: фаза ClientQuery та гістограма бази в /metrics
+ */
+static bool execClientTimed(QSqlQuery &query, const ClientDBLease &lease, Metrics &metrics) {
+    QElapsedTimer timer;
+    timer.start();
+    const bool ok = execTimed(query, RequestTrace::ClientQuery);
+    metrics.observeClientQuery(lease.clientLabel(), timer.nsecsElapsed());
+    if (!ok) {
+        noteClientTimeout(query);
+    }
+    return ok;
+}
+
+/**
+ * @brief Чи обірвалося читання курсора бази клієнта (помилка або тайм-аут посеред вибірки)
+ *
+ * Викликається після циклу next(): кінець даних помилки не встановлює, тож неповний
+ * результат не потрапить у відповідь і в кеш.
+ */
+static bool clientFetchFailed(const QSqlQuery &query, ClientDBLease &lease) {
+    if (!query.lastError().isValid()) {
+        return false;
+    }
+    qWarning() << "⚠️ Помилка читання результату з БД клієнта:" << query.lastError().text();
+    noteClientTimeout(query);
+    lease.invalidate();
+    return true;
+}
 
+/**
+ * @brief Читає ціле число з JSON: лише число без дробової частини в межах int (рядки, null тощо — ні)
+ */
+static bool jsonToInt(const QJsonValue &value, int *out) {
+    if (!value.isDouble()) {
+        return false;
+    }
+    const double number = value.toDouble();
+    if (number != std::floor(number) || number < std::numeric_limits<int>::min()
+        || number > std::numeric_limits<int>::max()) {
+        return false;
+    }
+    *out = int(number);
+    return true;
+}
 
+/**
+ * @brief Бере підключення до бази клієнта з пулу, зараховуючи час очікування та підключення
+ */
+static ClientDBLease acquireTimed(ClientDBPool *pool, const ClientDBParams &params) {
+    RequestTrace::Scope timing(RequestTrace::ClientConnect);
+    return pool->acquire(params);
+}
+
+/**
+ * @brief Серіалізує JSON-об'єкт, зараховуючи час до фази Serialize
+ */
+static QByteArray toJsonTimed(const QJsonObject &object) {
+    RequestTrace::Scope timing(RequestTrace::Serialize);
+    return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+using ResponderArg = QHttpServerResponder &;
+#else
+using ResponderArg = QHttpServerResponder &&;
+#endif
+
+// 🔹 Результат пошуку АЗС в основній базі для /terminal_info
+struct TerminalLookup {
+    QJsonObject fields;  // client_name, terminal_id, adress, phone
+    QByteArray error;    // тіло відповіді з помилкою, якщо рядок не отримано
+    qint64 elapsedNs = 0;
+};
 
 /**
  * @brief Конструктор класу Server
  * @param config Вказівник на об'єкт конфігурації
  * @param parent Батьківський QObject
  */
-Server::Server(Config *config, QObject *parent) : QObject(parent), config(config) {
+Server::Server(Config *config, QObject *parent)
+    : QObject(parent), config(config), paramsCache(config->getClientParamsTtlSec()),
+      responseCache(config->getResponseCacheMaxEntries(), qint64(config->getResponseCacheMaxSizeMb()) * 1024 * 1024) {
     port = config->getServerPort();
+
+    ClientDBPoolSettings poolSettings;
+    poolSettings.keepIdle = config->getClientPoolKeepIdle();
+    poolSettings.maxSize = config->getClientPoolMaxSize();
+    poolSettings.idleTimeoutSec = config->getClientPoolIdleTimeoutSec();
+    poolSettings.borrowTimeoutMs = config->getClientPoolBorrowTimeoutMs();
+    poolSettings.validateIdleSec = config->getClientPoolValidateIdleSec();
+    poolSettings.breakerFailures = config->getClientPoolBreakerFailures();
+    poolSettings.breakerOpenSec = config->getClientPoolBreakerOpenSec();
+    clientPool = new ClientDBPool(poolSettings, this);
+
+    ClientDBParams centralParams;
+    centralParams.server = config->getDatabaseHost();
+    centralParams.port = config->getDatabasePort();
+    centralParams.database = config->getDatabaseName();
+    centralParams.username = config->getDatabaseUser();
+    centralParams.password = config->getDatabasePassword();
+    healthMonitor = std::make_unique<HealthMonitor>(centralParams, clientPool, config->getHealthProbeIntervalSec());
+
+    // 🔹 Кешуємо лише маршрути зі статичною конфігурацією АЗС
+    for (const QString &route : {QStringLiteral("terminal_info"), QStringLiteral("reservoirs_info"), QStringLiteral("azs_list")}) {
+        responseCache.setRouteTtl("/" + route, config->getResponseCacheTtlSec(route));
+    }
+
+    // 🔹 Потоки обробників живуть весь час роботи сервера, щоб зберігати свої підключення
+    workerPool.setMaxThreadCount(qMax(1, config->getServerWorkers()));
+    workerPool.setExpiryTimeout(-1);
+    // 🔹 Допоміжні потоки для паралельних запитів усередині обробника; окремий пул, щоб обробники,
+    //    які чекають на результат, не займали потоки, потрібні для його обчислення
+    fanOutPool.setMaxThreadCount(workerPool.maxThreadCount());
+    fanOutPool.setExpiryTimeout(-1);
+    // 🔹 Потоки опитування баз клієнтів для /fleet/*: їхня кількість і є межею паралельності
+    fleetPool.setMaxThreadCount(qMax(1, config->getFleetMaxConcurrency()));
+    fleetPool.setExpiryTimeout(-1);
+    maxQueue = qMax(1, config->getServerMaxQueue());
+    compressionMinSize = config->getCompressionEnabled() ? qMax(1, config->getCompressionMinSize()) : 0;
+    compressionLevel = qBound(1, config->getCompressionLevel(), 9);
+    qInfo() << "✅ Робочих потоків:" << workerPool.maxThreadCount() << ", максимум запитів у черзі:" << maxQueue;
+    qInfo() << "🔹 Реалізація AES для паролів баз клієнтів:" << AesBackend::name(AesBackend::active());
+
     if (!connectToDatabase()) {
         qCritical() << "❌ Failed to connect to database!";
+    } else {
+        warmUpClientParams();
     }
 }
 
@@ -44,12 +210,387 @@ bool Server::connectToDatabase() {
     return true;
 }
 
+/**
+ * @brief Повертає підключення до основної бази для поточного потоку
+ *
+ * QSqlDatabase можна використовувати лише в потоці, де його створено,
+ * тому кожен робочий потік отримує власну копію основного підключення.
+ * @return Відкрите підключення (або закрите, якщо база недоступна)
+ */
+QSqlDatabase Server::centralDatabase() {
+    if (QThread::currentThread() == thread()) {
+        return db;
+    }
+
+    const QString connectionName = QString("central_%1").arg(quintptr(QThread::currentThreadId()));
+    QSqlDatabase centralDB = QSqlDatabase::contains(connectionName)
+                                 ? QSqlDatabase::database(connectionName, false)
+                                 : QSqlDatabase::cloneDatabase(QSqlDatabase::defaultConnection, connectionName);
+
+    if (!centralDB.isOpen() && !centralDB.open()) {
+        qCritical() << "❌ Database connection failed:" << centralDB.lastError().text();
+    }
+    return centralDB;
+}
+
+/**
+ * @brief Повертає підготовлений запит до основної бази для поточного потоку
+ *
+ * Запит готується один раз на підключення потоку, далі лише перев'язуються параметри.
+ * @param name Ім'я запиту в реєстрі
+ * @param sql Текст запиту
+ * @return Запит, готовий до bindValue()/exec()
+ */
+QSqlQuery &Server::centralStatement(const QString &name, const QString &sql) {
+    if (!centralStatements.hasLocalData()) {
+        centralStatements.setLocalData(new StatementCache());
+    }
+    return centralStatements.localData()->prepare(centralDatabase(), name, sql);
+}
+
+/**
+ * @brief Повертає значення заголовка запиту (без урахування регістру назви)
+ */
+static QByteArray headerValue(const QHttpServerRequest &request, const QByteArray &name) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    return request.headers().value(name).toByteArray();
+#else
+    return request.value(name);
+#endif
+}
+
+/**
+ * @brief Додає заголовок до відповіді
+ */
+static void addResponseHeader(QHttpServerResponse &response, const QByteArray &name, const QByteArray &value) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    QHttpHeaders headers = response.headers();
+    headers.append(name, value);
+    response.setHeaders(std::move(headers));
+#else
+    response.addHeader(name, value);
+#endif
+}
+
+/**
+ * @brief Чи є відповідь помилкою: статус 4xx/5xx або тіло `{"error": ...}` (так помилки повертає більшість маршрутів)
+ */
+static bool isErrorResponse(int status, const QByteArray &body) {
+    return status >= 400 || body.startsWith(R"({"error")");
+}
+
+/**
+ * @brief Відповідь `504`, коли база клієнта не відповіла вчасно
+ */
+static QHttpServerResponse gatewayTimeoutResponse() {
+    return QHttpServerResponse("application/json", R"({"error": "Client database timeout"})",
+                               QHttpServerResponse::StatusCode::GatewayTimeout);
+}
+
+/**
+ * @brief Копіює з HTTP-запиту дані, потрібні обробнику в робочому потоці
+ */
+RequestContext RequestContext::fromRequest(const QHttpServerRequest &request) {
+    RequestContext context;
+    context.query = request.query();
+    context.body = request.body();
+    context.ifNoneMatch = headerValue(request, "If-None-Match");
+    context.accept = headerValue(request, "Accept");
+    context.acceptEncoding = headerValue(request, "Accept-Encoding");
+    context.route = request.url().path();
+    context.remoteAddress = request.remoteAddress();
+    context.remotePort = request.remotePort();
+
+    // 🔹 Id запиту з X-Request-Id (якщо його задав клієнт або балансувальник), інакше новий
+    const QByteArray requestId = headerValue(request, "X-Request-Id").trimmed();
+    context.requestId = (!requestId.isEmpty() && requestId.size() <= 64) ? requestId : RequestTrace::nextRequestId();
+    return context;
+}
+
+/**
+ * @brief Чи просить клієнт NDJSON (`Accept: application/x-ndjson`)
+ */
+bool RequestContext::wantsNdjson() const {
+    return accept.contains("application/x-ndjson");
+}
+
+/**
+ * @brief Чи віддавати список частинами: NDJSON або параметр `stream=1`
+ */
+bool RequestContext::wantsStream() const {
+    const QString stream = query.queryItemValue("stream");
+    return wantsNdjson() || stream == "1" || stream == "true";
+}
+
+/**
+ * @brief Обчислює сильний ETag за серіалізованим тілом відповіді
+ */
+QByteArray Server::makeETag(const QByteArray &body) {
+    return '"' + QCryptographicHash::hash(body, QCryptographicHash::Sha1).toHex() + '"';
+}
+
+/**
+ * @brief Перевіряє, чи збігається ETag з одним зі значень If-None-Match
+ */
+static bool etagMatches(const QByteArray &ifNoneMatch, const QByteArray &etag) {
+    if (ifNoneMatch.isEmpty()) {
+        return false;
+    }
+    for (QByteArray candidate : ifNoneMatch.split(',')) {
+        candidate = candidate.trimmed();
+        if (candidate == "*") {
+            return true;
+        }
+        // 🔹 If-None-Match порівнюється слабко: префікс W/ ігноруємо
+        if (candidate.startsWith("W/")) {
+            candidate = candidate.mid(2);
+        }
+        if (candidate == etag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Стискає тіло gzip заздалегідь (для кешу відповідей), якщо воно не менше порогу стиснення
+ * @return Стиснене тіло або порожній масив
+ */
+QByteArray Server::precompress(const QByteArray &body) const {
+    if (compressionMinSize <= 0 || body.size() < compressionMinSize) {
+        return QByteArray();
+    }
+    RequestTrace::Scope timing(RequestTrace::Serialize);
+    return Compression::gzip(body, compressionLevel);
+}
+
+/**
+ * @brief Формує успішну JSON-відповідь з ETag та Cache-Control маршруту
+ *
+ * Якщо клієнт надіслав If-None-Match з тим самим ETag, повертає `304 Not Modified` без тіла.
+ * Тіло від `[Compression] min_size` байтів стискається за Accept-Encoding (gzip або deflate);
+ * стиснена версія має власний ETag із суфіксом `-gzip`/`-deflate`.
+ * @param request Дані запиту
+ * @param route Маршрут (ключ налаштувань `[CacheControl]`)
+ * @param body Серіалізоване тіло
+ * @param etag Готовий ETag (наприклад, з кешу відповідей); якщо порожній — обчислюється
+ * @param gzipped Готова gzip-версія тіла з кешу; якщо порожня — стискається за потреби
+ */
+QHttpServerResponse Server::jsonResponse(const RequestContext &request, const QString &route,
+                                         const QByteArray &body, QByteArray etag, QByteArray gzipped) {
+    if (etag.isEmpty()) {
+        etag = makeETag(body);
+    }
+    const QByteArray cacheControl = config->getCacheControl(route.mid(1)).toUtf8();
+
+    Compression::Encoding encoding = Compression::Identity;
+    if (compressionMinSize > 0 && body.size() >= compressionMinSize) {
+        encoding = Compression::negotiate(request.acceptEncoding);
+    }
+    const QByteArray encodedEtag = encoding == Compression::Identity
+                                       ? etag
+                                       : etag.chopped(1) + '-' + Compression::name(encoding) + '"';
+
+    if (etagMatches(request.ifNoneMatch, encodedEtag) || etagMatches(request.ifNoneMatch, etag)) {
+        QHttpServerResponse notModified(QHttpServerResponse::StatusCode::NotModified);
+        addResponseHeader(notModified, "ETag", encodedEtag);
+        addResponseHeader(notModified, "Cache-Control", cacheControl);
+        if (compressionMinSize > 0) {
+            addResponseHeader(notModified, "Vary", "Accept-Encoding");
+        }
+        return notModified;
+    }
+
+    if (encoding == Compression::Identity) {
+        QHttpServerResponse response("application/json; charset=utf-8", body);
+        addResponseHeader(response, "ETag", etag);
+        addResponseHeader(response, "Cache-Control", cacheControl);
+        if (compressionMinSize > 0) {
+            addResponseHeader(response, "Vary", "Accept-Encoding");
+        }
+        return response;
+    }
+
+    if (encoding != Compression::Gzip || gzipped.isEmpty()) {
+        RequestTrace::Scope timing(RequestTrace::Serialize);
+        gzipped = Compression::compress(body, encoding, compressionLevel);
+    }
+    QHttpServerResponse response("application/json; charset=utf-8", gzipped);
+    addResponseHeader(response, "Content-Encoding", Compression::name(encoding));
+    addResponseHeader(response, "Vary", "Accept-Encoding");
+    addResponseHeader(response, "ETag", encodedEtag);
+    addResponseHeader(response, "Cache-Control", cacheControl);
+    return response;
+}
+
+/**
+ * @brief Кладе тіло в кеш відповідей (разом з ETag та gzip-версією) і формує відповідь
+ */
+QHttpServerResponse Server::cachedJsonResponse(const RequestContext &request, const QString &route,
+                                               const QByteArray &body) {
+    ResponseCache::CachedResponse cached{body, makeETag(body), precompress(body)};
+    responseCache.put(route, request.query, cached);
+    return jsonResponse(request, route, cached.body, cached.etag, cached.gzipped);
+}
+
+/**
+ * @brief Передає обробник у пул робочих потоків
+ *
+ * Якщо в обробці вже maxQueue запитів, одразу відповідає 503, щоб черга не росла безмежно.
+ * Обробка супроводжується RequestTrace, відповідь отримує заголовок X-Request-Id.
+ *
+ * Якщо задано timeoutMs і обробник не встиг (наприклад, завис на недоступній базі клієнта),
+ * клієнт одразу отримує 504, а пізня відповідь обробника відкидається. Сам потік
+ * звільниться, коли поверне керування драйвер бази.
+ * @param request Дані запиту
+ * @param handler Обробник, що формує відповідь
+ * @param timeoutMs Сторожовий тайм-аут від моменту надходження запиту (0 — без нього)
+ * @return Майбутня відповідь для QHttpServer
+ */
+QFuture<QHttpServerResponse> Server::dispatch(const RequestContext &request, std::function<QHttpServerResponse()> handler,
+                                              int timeoutMs) {
+    if (pendingRequests.fetchAndAddRelaxed(1) >= maxQueue) {
+        pendingRequests.fetchAndSubRelaxed(1);
+        qWarning() << "⚠️ Черга запитів переповнена, відповідаємо 503";
+        metrics.observeRequest(request.route, true, 0);
+
+        QPromise<QHttpServerResponse> promise;
+        QFuture<QHttpServerResponse> future = promise.future();
+        promise.start();
+        promise.addResult(QHttpServerResponse("application/json", R"({"error": "Server is busy"})",
+                                              QHttpServerResponse::StatusCode::ServiceUnavailable));
+        promise.finish();
+        return future;
+    }
+
+    // 🔹 Відповідь дає той, хто встиг першим: обробник або сторожовий таймер (504)
+    auto promise = std::make_shared<QPromise<QHttpServerResponse>>();
+    auto answered = std::make_shared<std::atomic<bool>>(false);
+    QFuture<QHttpServerResponse> future = promise->future();
+    promise->start();
+
+    if (timeoutMs > 0) {
+        QTimer::singleShot(timeoutMs, this, [promise, answered, requestId = request.requestId, route = request.route]() {
+            if (answered->exchange(true)) {
+                return;
+            }
+            qWarning() << "⚠️ Обробник" << route << "не відповів вчасно, відповідаємо 504; id =" << requestId;
+            QHttpServerResponse response = gatewayTimeoutResponse();
+            addResponseHeader(response, "X-Request-Id", requestId);
+            promise->addResult(std::move(response));
+            promise->finish();
+        });
+    }
+
+    workerPool.start([this, promise, answered, requestId = request.requestId, route = request.route,
+                      query = request.query, handler = std::move(handler)]() {
+        QElapsedTimer timer;
+        timer.start();
+        RequestTrace trace(requestId, route, query);
+        QHttpServerResponse response = handler();
+        // 🔹 Запит до бази клієнта перервано за statement timeout — це теж 504
+        if (trace.isTimedOut()) {
+            response = gatewayTimeoutResponse();
+        }
+        addResponseHeader(response, "X-Request-Id", requestId);
+
+        const bool late = answered->exchange(true);
+        const int status = late ? int(QHttpServerResponse::StatusCode::GatewayTimeout) : int(response.statusCode());
+        trace.finish(status, late ? 0 : response.data().size());
+        metrics.observeRequest(route, late || isErrorResponse(status, response.data()), timer.nsecsElapsed());
+        if (late) {
+            qWarning() << "⚠️ Обробник" << route << "завершився через" << timer.elapsed()
+                       << "мс, уже після відповіді 504; id =" << requestId;
+        } else {
+            promise->addResult(std::move(response));
+            promise->finish();
+        }
+        pendingRequests.fetchAndSubRelaxed(1);
+    });
+    return future;
+}
+
+
+/**
+ * @brief Передає в пул робочих потоків обробник, що сам пише у відповідь (зокрема частинами)
+ *
+ * Обмеження черги та траса запиту — як у dispatch().
+ * @param request Дані запиту
+ * @param stream Відповідь запиту
+ * @param handler Обробник, що пише у stream
+ */
+void Server::dispatchStream(const RequestContext &request, std::shared_ptr<ResponseStream> stream,
+                            std::function<void(ResponseStream &)> handler) {
+    if (pendingRequests.fetchAndAddRelaxed(1) >= maxQueue) {
+        pendingRequests.fetchAndSubRelaxed(1);
+        qWarning() << "⚠️ Черга запитів переповнена, відповідаємо 503";
+        metrics.observeRequest(request.route, true, 0);
+        stream->send(QHttpServerResponse("application/json", R"({"error": "Server is busy"})",
+                                         QHttpServerResponse::StatusCode::ServiceUnavailable));
+        return;
+    }
+
+    workerPool.start([this, requestId = request.requestId, route = request.route, query = request.query,
+                      stream = std::move(stream), handler = std::move(handler)]() {
+        QElapsedTimer timer;
+        timer.start();
+        RequestTrace trace(requestId, route, query);
+        handler(*stream);
+        trace.finish(stream->statusCode(), stream->bytesWritten());
+        metrics.observeRequest(route, stream->isError(), timer.nsecsElapsed());
+        pendingRequests.fetchAndSubRelaxed(1);
+    });
+}
+
+/**
+ * @brief Сторожовий тайм-аут запиту до бази клієнта: `[ClientTimeouts]` з урахуванням client_id запиту
+ */
+int Server::clientRequestTimeoutMs(const RequestContext &request) const {
+    bool ok = false;
+    int clientId = request.query.queryItemValue("client_id").toInt(&ok);
+    // 🔹 POST-маршрути (/terminal_info/batch) передають client_id у JSON-тілі
+    if (!ok && !request.body.isEmpty()) {
+        ok = jsonToInt(QJsonDocument::fromJson(request.body).object().value("client_id"), &clientId);
+    }
+    return config->getClientRequestTimeoutMs(ok ? clientId : -1);
+}
+
+/**
+ * @brief Створює відповідь для маршруту, що вміє віддавати список частинами
+ */
+std::shared_ptr<ResponseStream> Server::makeStream(const RequestContext &request, const QString &route,
+                                                   QHttpServerResponder &&responder) {
+    const QByteArray contentType = request.wantsNdjson() ? "application/x-ndjson; charset=utf-8"
+                                                         : "application/json; charset=utf-8";
+    return std::make_shared<ResponseStream>(this, requestSocket(request), std::move(responder), contentType,
+                                            config->getCacheControl(route.mid(1)).toUtf8(), request.requestId);
+}
+
+/**
+ * @brief Знаходить сокет з'єднання запиту (у потоці сервера)
+ *
+ * QHttpServerResponder не дає доступу до сокета, але з'єднання — нащадки httpServer
+ * (через його QTcpServer), і клієнта однозначно визначають адреса та порт.
+ * @return Сокет або nullptr, якщо з'єднання вже немає
+ */
+QTcpSocket *Server::requestSocket(const RequestContext &request) const {
+    const QList<QTcpSocket *> sockets = httpServer.findChildren<QTcpSocket *>();
+    for (QTcpSocket *socket : sockets) {
+        if (socket->peerPort() == request.remotePort && socket->peerAddress() == request.remoteAddress) {
+            return socket;
+        }
+    }
+    qWarning() << "⚠️ Сокет потокової відповіді не знайдено, обмежується лише черга потоку сервера; id ="
+               << request.requestId;
+    return nullptr;
+}
 
 /**
  * @brief Запускає сервер на вказаному порту
  */
 void Server::start() {
     setupRoutes();  // 🔹 Додаємо маршрути перед запуском сервера
+    healthMonitor->start();
     QString serverAddress = QString("http://localhost:%1").arg(port);
     if (!httpServer.listen(QHostAddress::Any, port)) {
         qCritical() << "Failed to start server " << serverAddress;
@@ -63,84 +604,353 @@ void Server::start() {
  * @brief Налаштовує маршрути для обробки HTTP-запитів
  */
 void Server::setupRoutes() {
-    httpServer.route("/status", [this]() { return handleStatus(); });
+    // 🔹 Маршрути, що обробляються в робочих потоках, для /metrics
+    for (const char *route : {"/clients", "/clients/<id>", "/terminal_info", "/terminal_info/batch",
+                              "/pos_info", "/reservoirs_info", "/azs_list", "/fleet/reservoirs", "/fleet/pos_versions"}) {
+        metrics.registerRoute(QLatin1String(route));
+    }
+
+    httpServer.route("/status", [this](const QHttpServerRequest &request) {
+        return handleStatus(RequestContext::fromRequest(request));
+    });
     qDebug() << "🔹 Route `/status` added.";
 
-    httpServer.route("/clients", [this]() -> QHttpServerResponse { return handleData(); });
+    httpServer.route("/stats", QHttpServerRequest::Method::Get, [this](const QHttpServerRequest &request) {
+        return handleStats(RequestContext::fromRequest(request));
+    });
+    qDebug() << "🔹 Route `/stats` added.";
+
+    httpServer.route("/metrics", QHttpServerRequest::Method::Get, [this](const QHttpServerRequest &) {
+        return handleMetrics();
+    });
+    qDebug() << "🔹 Route `/metrics` added.";
+
+    httpServer.route("/client_params/invalidate", QHttpServerRequest::Method::Post,
+                     [this](const QHttpServerRequest &request) {
+                         return handleInvalidateClientParams(RequestContext::fromRequest(request));
+                     });
+    qDebug() << "🔹 Route `/client_params/invalidate` added.";
+
+    httpServer.route("/clients", [this](const QHttpServerRequest &request, ResponderArg responder) {
+        RequestContext context = RequestContext::fromRequest(request);
+        dispatchStream(context, makeStream(context, "/clients", std::move(responder)),
+                       [this, context](ResponseStream &stream) { handleData(context, stream); });
+    });
     qDebug() << "?? Route `/clients` added.";
 
-    httpServer.route("/clients/<arg>", [this](const QString &clientId) {
-        return handleDataById(clientId.toInt());
+    httpServer.route("/clients/<arg>", [this](const QString &clientId, const QHttpServerRequest &request) {
+        RequestContext context = RequestContext::fromRequest(request);
+        return dispatch(context, [this, clientId, context]() { return handleDataById(clientId.toInt(), context); });
     });
     qDebug() << "Route `/data/<id>` added.";
 
+    httpServer.route("/terminal_info/batch", QHttpServerRequest::Method::Post,
+                     [this](const QHttpServerRequest &request) {
+                         RequestContext context = RequestContext::fromRequest(request);
+                         return dispatch(context, [this, context]() { return handleTerminalInfoBatch(context); }, clientRequestTimeoutMs(context));
+                     });
+    qDebug() << "✅ Route `/terminal_info/batch` added.";
+
     httpServer.route("/terminal_info", [this](const QHttpServerRequest &request) {
-        return handleTerminalInfo(request);
+        RequestContext context = RequestContext::fromRequest(request);
+        return dispatch(context, [this, context]() { return handleTerminalInfo(context); }, clientRequestTimeoutMs(context));
     });
     qDebug() << "✅ Route `/terminal_info` added.";
     httpServer.route("/pos_info", QHttpServerRequest::Method::Get,
                  [this](const QHttpServerRequest &request) {
-                     return handlePosInfo(request);
+                     RequestContext context = RequestContext::fromRequest(request);
+                     return dispatch(context, [this, context]() { return handlePosInfo(context); }, clientRequestTimeoutMs(context));
                  });
     httpServer.route("/reservoirs_info", QHttpServerRequest::Method::Get,
                      [this](const QHttpServerRequest &request) {
-                         return handleReservoirsInfo(request);
+                         RequestContext context = RequestContext::fromRequest(request);
+                         return dispatch(context, [this, context]() { return handleReservoirsInfo(context); }, clientRequestTimeoutMs(context));
                      });
     httpServer.route("/azs_list", QHttpServerRequest::Method::Get,
-                     [this](const QHttpServerRequest &request) {
-                         return handleAzsList(request);
+                     [this](const QHttpServerRequest &request, ResponderArg responder) {
+                         RequestContext context = RequestContext::fromRequest(request);
+                         dispatchStream(context, makeStream(context, "/azs_list", std::move(responder)),
+                                        [this, context](ResponseStream &stream) { handleAzsList(context, stream); });
                      });
 
+    for (const QString route : {QStringLiteral("/fleet/reservoirs"), QStringLiteral("/fleet/pos_versions")}) {
+        httpServer.route(route, QHttpServerRequest::Method::Get, [this, route](const QHttpServerRequest &request) {
+            RequestContext context = RequestContext::fromRequest(request);
+            return dispatch(context, [this, context, route]() { return handleFleet(context, route); });
+        });
+        qDebug() << "✅ Route" << route << "added.";
+    }
+
 
 }
 
-QHttpServerResponse Server::handleAzsList(const QHttpServerRequest &request) {
-    QUrlQuery queryParams(request.query());  // ✅ Перейменовано для уникнення конфлікту
+// 🔹 Опис спискового маршруту: колонки (перша — ключ курсора) та умова вибірки
+struct ListSpec {
+    const char *name;      // префікс імені в реєстрі підготовлених запитів
+    const char *arrayKey;  // назва масиву у JSON-відповіді
+    QList<QPair<const char *, const char *>> columns;  // поле JSON → вираз у SELECT
+    const char *from;      // FROM ... WHERE ... (без ORDER BY)
+};
+
+static const ListSpec kClientsList = {
+    "clients", "data",
+    {{"id", "client_id"}, {"name", "client_name"}},
+    "FROM clients_list WHERE isactive=1"};
+
+static const ListSpec kAzsList = {
+    "azs_list", "azs_list",
+    {{"terminal_id", "t.terminal_id"}, {"name", "t.name"}},
+    "FROM terminals t WHERE t.client_id = ?"};
+
+// 🔹 Параметри сторінки: `fields`, `limit`, `after`
+struct ListPage {
+    quint32 fieldMask = 0;     // біт i — колонка columns[i] потрапляє у відповідь
+    int limit = 0;             // 0 — без обмеження
+    std::optional<int> after;  // ключ останнього рядка попередньої сторінки
+};
+
+/**
+ * @brief Розбирає параметри сторінки спискового маршруту
+ * @param error Текст помилки для відповіді, якщо параметри некоректні
+ * @return false, якщо параметри некоректні
+ */
+static bool parseListPage(const QUrlQuery &query, const ListSpec &spec, int maxPageSize,
+                          ListPage *page, QByteArray *error) {
+    page->fieldMask = (1u << spec.columns.size()) - 1;
+    if (query.hasQueryItem("fields")) {
+        page->fieldMask = 0;
+        const QStringList fields = query.queryItemValue("fields").split(',', Qt::SkipEmptyParts);
+        for (const QString &field : fields) {
+            qsizetype index = 0;
+            while (index < spec.columns.size() && field.trimmed() != QLatin1String(spec.columns[index].first)) {
+                ++index;
+            }
+            if (index == spec.columns.size()) {
+                *error = R"({"error": "Invalid fields parameter"})";
+                return false;
+            }
+            page->fieldMask |= 1u << index;
+        }
+        if (page->fieldMask == 0) {
+            *error = R"({"error": "Invalid fields parameter"})";
+            return false;
+        }
+    }
+
+    if (query.hasQueryItem("limit")) {
+        bool ok = false;
+        page->limit = query.queryItemValue("limit").toInt(&ok);
+        if (!ok || page->limit <= 0) {
+            *error = R"({"error": "Invalid limit parameter"})";
+            return false;
+        }
+        page->limit = qMin(page->limit, qMax(1, maxPageSize));
+    }
+
+    if (query.hasQueryItem("after")) {
+        bool ok = false;
+        page->after = query.queryItemValue("after").toInt(&ok);
+        if (!ok) {
+            *error = R"({"error": "Invalid after parameter"})";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Ім'я підготовленого запиту для комбінації полів, limit та after
+ */
+static QString listStatementName(const ListSpec &spec, const ListPage &page) {
+    return QString("%1_f%2%3%4").arg(spec.name).arg(page.fieldMask)
+        .arg(QLatin1String(page.limit > 0 ? "_first" : ""), QLatin1String(page.after ? "_after" : ""));
+}
+
+/**
+ * @brief Будує SELECT лише з потрібних колонок з keyset-пагінацією
+ *
+ * Ключова колонка вибирається завжди (для next_cursor). Параметри, у порядку
+ * прив'язки: `FIRST (?)` (якщо є limit), параметри spec.from, `> ?` (якщо є after).
+ */
+static QString listSql(const ListSpec &spec, const ListPage &page) {
+    const QString keyExpr = spec.columns[0].second;
+    QStringList select{keyExpr};
+    for (qsizetype i = 1; i < spec.columns.size(); ++i) {
+        if (page.fieldMask & (1u << i)) {
+            select.append(spec.columns[i].second);
+        }
+    }
+
+    QString sql = QString("SELECT %1%2 %3")
+                      .arg(QLatin1String(page.limit > 0 ? "FIRST (?) " : ""), select.join(", "), QLatin1String(spec.from));
+    if (page.after) {
+        sql += QString(" AND %1 > ?").arg(keyExpr);
+    }
+    sql += QString(" ORDER BY %1").arg(keyExpr);
+    return sql;
+}
+
+/**
+ * @brief Прив'язує параметри запиту listSql()
+ */
+static void bindListQuery(QSqlQuery &query, const ListPage &page, const QVariantList &fromParams) {
+    if (page.limit > 0) {
+        query.addBindValue(page.limit);
+    }
+    for (const QVariant &param : fromParams) {
+        query.addBindValue(param);
+    }
+    if (page.after) {
+        query.addBindValue(*page.after);
+    }
+}
+
+/**
+ * @brief Записує рядки курсора як `{"<key>": [...], "next_cursor": ...}` або як NDJSON (об'єкт на рядок)
+ *
+ * `next_cursor` додається лише для сторінок з `limit`: ключ останнього рядка, якщо сторінка
+ * повна, інакше null. У NDJSON обгортки немає — курсором є ключ останнього рядка, тому
+ * з `limit` ключ пишеться в кожен рядок, навіть якщо `fields` його не містить.
+ * @param query Виконаний запит listSql()
+ * @param spec Опис маршруту
+ * @param page Параметри сторінки
+ * @param ndjson Формат NDJSON
+ * @param stream Якщо задано — записане віддається в нього частинами по kStreamChunkBytes
+ * @return Ще не віддані байти (без stream — увесь документ); порожньо, якщо stream перервано
+ */
+static QByteArray writeList(QSqlQuery &query, const ListSpec &spec, const ListPage &page, bool ndjson,
+                            ResponseStream *stream) {
+    RequestTrace::Scope timing(RequestTrace::Serialize);
+
+    // 🔹 Порядок колонок у listSql(): ключ, далі вибрані поля
+    const bool writeKey = (page.fieldMask & 1u) || (ndjson && page.limit > 0);
+    QList<const char *> fields{writeKey ? spec.columns[0].first : nullptr};
+    for (qsizetype i = 1; i < spec.columns.size(); ++i) {
+        if (page.fieldMask & (1u << i)) {
+            fields.append(spec.columns[i].first);
+        }
+    }
+
+    JsonWriter writer(kListReserveBytes);
+    if (!ndjson) {
+        writer.beginObject().key(spec.arrayKey).beginArray();
+    }
+
+    int rows = 0;
+    int lastKey = 0;
+    while (query.next()) {
+        writer.beginObject();
+        for (qsizetype i = 0; i < fields.size(); ++i) {
+            if (fields[i]) {
+                writer.field(fields[i], query.value(int(i)));
+            }
+        }
+        writer.endObject();
+        if (ndjson) {
+            writer.lineBreak();
+        }
+
+        lastKey = query.value(0).toInt();
+        ++rows;
+        // 🔹 Передачу перервано (клієнт пішов або не читає) — курсор далі не читаємо
+        if (stream && writer.buffer().size() >= kStreamChunkBytes && !stream->write(writer.flush())) {
+            return QByteArray();
+        }
+    }
+
+    if (!ndjson) {
+        writer.endArray();
+        if (page.limit > 0) {
+            writer.key("next_cursor");
+            if (rows == page.limit) {
+                writer.value(lastKey);
+            } else {
+                writer.null();
+            }
+        }
+        writer.endObject();
+    }
+    return writer.take();
+}
+
+/**
+ * @brief Обробляє запит `/azs_list`: список АЗС клієнта
+ *
+ * Зі `stream=1` або `Accept: application/x-ndjson` рядки віддаються частинами по мірі
+ * читання курсора, без кешу та ETag.
+ * @param request Дані запиту з параметром `client_id`
+ * @param stream Відповідь запиту
+ */
+void Server::handleAzsList(const RequestContext &request, ResponseStream &stream) {
+    const QUrlQuery &queryParams = request.query;  // ✅ Перейменовано для уникнення конфлікту
     qDebug() << "📥 Запит отримано: /azs_list";
 
     if (!queryParams.hasQueryItem("client_id")) {
-        return QHttpServerResponse("application/json", R"({"error": "Missing client_id parameter"})");
+        stream.send(QHttpServerResponse("application/json", R"({"error": "Missing client_id parameter"})"));
+        return;
     }
 
     int clientId = queryParams.queryItemValue("client_id").toInt();
+    const bool streaming = request.wantsStream();
+
+    ListPage page;
+    QByteArray pageError;
+    if (!parseListPage(queryParams, kAzsList, config->getServerMaxPageSize(), &page, &pageError)) {
+        stream.send(QHttpServerResponse("application/json", pageError));
+        return;
+    }
+
+    if (!streaming) {
+        if (auto cached = responseCache.get("/azs_list", queryParams)) {
+            stream.send(jsonResponse(request, "/azs_list", cached->body, cached->etag, cached->gzipped));
+            return;
+        }
+    }
 
-    QSqlDatabase db = QSqlDatabase::database();  // Використовуємо основну базу
-    if (!db.isOpen()) {
+    QSqlDatabase centralDB = centralDatabase();  // Використовуємо основну базу
+    if (!centralDB.isOpen()) {
         qWarning() << "⚠️ Основна база не підключена!";
-        return QHttpServerResponse("application/json", R"({"error": "Database is not connected"})");
+        stream.send(QHttpServerResponse("application/json", R"({"error": "Database is not connected"})"));
+        return;
     }
 
-    QSqlQuery sqlQuery(db);  // ✅ Перейменовано для уникнення конфлікту
-    QString sql = QString(R"(
-        SELECT t.terminal_id, t.name
-        FROM terminals t
-        WHERE t.client_id = %1
-        ORDER BY t.terminal_id;
-    )").arg(clientId);
+    QSqlQuery &sqlQuery = centralStatement(listStatementName(kAzsList, page), listSql(kAzsList, page));
+    bindListQuery(sqlQuery, page, {clientId});
 
-    if (!sqlQuery.exec(sql)) {
+    if (!execTimed(sqlQuery, RequestTrace::CentralDb)) {
         qWarning() << "❌ Помилка SQL-запиту:" << sqlQuery.lastError().text();
-        return QHttpServerResponse("application/json", R"({"error": "Database query failed"})");
+        stream.send(QHttpServerResponse("application/json", R"({"error": "Database query failed"})"));
+        return;
     }
 
-    QJsonArray azsArray;
-    while (sqlQuery.next()) {
-        QJsonObject azsObj;
-        azsObj["terminal_id"] = sqlQuery.value("terminal_id").toInt();
-        azsObj["name"] = sqlQuery.value("name").toString();
-        azsArray.append(azsObj);
+    if (streaming) {
+        stream.begin();
+        const QByteArray tail = writeList(sqlQuery, kAzsList, page, request.wantsNdjson(), &stream);
+        if (sqlQuery.lastError().isValid()) {
+            qWarning() << "❌ Помилка читання результату SQL-запиту:" << sqlQuery.lastError().text();
+            stream.fail(QHttpServerResponse("application/json", R"({"error": "Database query failed"})"));
+            return;
+        }
+        stream.write(tail);
+        stream.end();
+        return;
     }
 
-    QJsonObject response;
-    response["azs_list"] = azsArray;
-
-    return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+    // 🔹 Рядки курсора пишемо одразу в JSON-буфер, без проміжного QJsonArray
+    QByteArray jsonData = writeList(sqlQuery, kAzsList, page, false, nullptr);
+    // 🔹 Обірвана вибірка не кешується
+    if (sqlQuery.lastError().isValid()) {
+        qWarning() << "❌ Помилка читання результату SQL-запиту:" << sqlQuery.lastError().text();
+        stream.send(QHttpServerResponse("application/json", R"({"error": "Database query failed"})"));
+        return;
+    }
+    stream.send(cachedJsonResponse(request, "/azs_list", jsonData));
 }
 
 
 
-QHttpServerResponse Server::handleReservoirsInfo(const QHttpServerRequest &request) {
-    QUrlQuery query(request.query());
+QHttpServerResponse Server::handleReservoirsInfo(const RequestContext &request) {
+    const QUrlQuery &query = request.query;
     qDebug() << "📥 Отримано запит: /reservoirs_info";
 
     // Перевіряємо наявність параметрів
@@ -151,6 +961,10 @@ QHttpServerResponse Server::handleReservoirsInfo(const QHttpServerRequest &reque
     int clientId = query.queryItemValue("client_id").toInt();
     int terminalId = query.queryItemValue("terminal_id").toInt();
 
+    if (auto cached = responseCache.get("/reservoirs_info", query)) {
+        return jsonResponse(request, "/reservoirs_info", cached->body, cached->etag, cached->gzipped);
+    }
+
     // 🔹 Отримуємо параметри підключення до БД клієнта
     auto clientDbParams = getClientDBParams(clientId);
     if (!clientDbParams.has_value()) {
@@ -158,18 +972,15 @@ QHttpServerResponse Server::handleReservoirsInfo(const QHttpServerRequest &reque
         return QHttpServerResponse("application/json", R"({"error": "Failed to get client DB parameters"})");
     }
 
-    // 🔹 Підключаємося до бази даних клієнта
-    if (!connectToClientDatabase(clientDbParams.value())) {
+    // 🔹 Беремо підключення до бази даних клієнта з пулу
+    ClientDBLease clientLease = acquireTimed(clientPool, clientDbParams.value());
+    if (!clientLease) {
         qWarning() << "⚠️ Помилка підключення до БД клієнта!";
         return QHttpServerResponse("application/json", R"({"error": "Failed to connect to client database"})");
     }
 
-    QString connectionName = QString("clientDB_%1").arg(clientDbParams->server);
-    QSqlDatabase clientDB = QSqlDatabase::database(connectionName);
-
     // 🔹 Виконуємо SQL-запит
-    QSqlQuery sqlQuery(clientDB);
-    sqlQuery.prepare(R"(
+    QSqlQuery &sqlQuery = clientLease.statement("reservoirs_info", R"(
         SELECT t.tank_id, t.fuel_id, f.shortname, f.name, t.maxvalue, t.minvalue,
                t.deadmax, t.deadmin, t.tubeamount
         FROM tanks t
@@ -179,32 +990,35 @@ QHttpServerResponse Server::handleReservoirsInfo(const QHttpServerRequest &reque
     )");
     sqlQuery.bindValue(":terminalId", terminalId);
 
-    if (!sqlQuery.exec()) {
+    if (!execClientTimed(sqlQuery, clientLease, metrics)) {
         qWarning() << "❌ Помилка виконання SQL-запиту:" << sqlQuery.lastError().text();
+        clientLease.invalidate();
         return QHttpServerResponse("application/json", R"({"error": "Database query failed"})");
     }
 
-    // 🔹 Формуємо JSON-відповідь
-    QJsonArray reservoirsArray;
+    // 🔹 Формуємо JSON-відповідь прямо з курсора
+    RequestTrace::Scope timing(RequestTrace::Serialize);
+    JsonWriter writer;
+    writer.beginObject().key("reservoirs_info").beginArray();
     while (sqlQuery.next()) {
-        QJsonObject tankObj;
-        tankObj["tank_id"] = sqlQuery.value("tank_id").toInt();
-        tankObj["fuel_id"] = sqlQuery.value("fuel_id").toInt();
-        tankObj["shortname"] = sqlQuery.value("shortname").toString();
-        tankObj["name"] = sqlQuery.value("name").toString();
-        tankObj["maxvalue"] = sqlQuery.value("maxvalue").toInt();
-        tankObj["minvalue"] = sqlQuery.value("minvalue").toInt();
-        tankObj["deadmax"] = sqlQuery.value("deadmax").toInt();
-        tankObj["deadmin"] = sqlQuery.value("deadmin").toInt();
-        tankObj["tubeamount"] = sqlQuery.value("tubeamount").toInt();
-        reservoirsArray.append(tankObj);
-    }
-
-    // 🔹 Формуємо фінальну відповідь
-    QJsonObject response;
-    response["reservoirs_info"] = reservoirsArray;
+        writer.beginObject()
+            .field("tank_id", sqlQuery.value(0).toInt())
+            .field("fuel_id", sqlQuery.value(1).toInt())
+            .field("shortname", sqlQuery.value(2).toString())
+            .field("name", sqlQuery.value(3).toString())
+            .field("maxvalue", sqlQuery.value(4).toInt())
+            .field("minvalue", sqlQuery.value(5).toInt())
+            .field("deadmax", sqlQuery.value(6).toInt())
+            .field("deadmin", sqlQuery.value(7).toInt())
+            .field("tubeamount", sqlQuery.value(8).toInt())
+            .endObject();
+    }
+    writer.endArray().endObject();
 
-    return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+    if (clientFetchFailed(sqlQuery, clientLease)) {
+        return QHttpServerResponse("application/json", R"({"error": "Database query failed"})");
+    }
+    return cachedJsonResponse(request, "/reservoirs_info", writer.take());
 }
 
 
@@ -213,8 +1027,8 @@ QHttpServerResponse Server::handleReservoirsInfo(const QHttpServerRequest &reque
  * @param request HTTP-запит з параметрами `client_id` та `terminal_id`
  * @return JSON-відповідь з інформацією про термінал або повідомленням про помилку
  */
-QHttpServerResponse Server::handleTerminalInfo(const QHttpServerRequest &request) {
-    QUrlQuery query(request.query());
+QHttpServerResponse Server::handleTerminalInfo(const RequestContext &request) {
+    const QUrlQuery &query = request.query;
     qDebug() << "📥 Запит отримано: /terminal_info";
 
     if (!query.hasQueryItem("client_id") || !query.hasQueryItem("terminal_id")) {
@@ -224,34 +1038,179 @@ QHttpServerResponse Server::handleTerminalInfo(const QHttpServerRequest &request
     int clientId = query.queryItemValue("client_id").toInt();
     int terminalId = query.queryItemValue("terminal_id").toInt();
 
-    // 🔹 Спочатку перевіряємо, чи є термінал у головній базі Palantir
-    QSqlQuery sqlQuery(db);
-    sqlQuery.prepare(R"(
+    if (auto cached = responseCache.get("/terminal_info", query)) {
+        return jsonResponse(request, "/terminal_info", cached->body, cached->etag, cached->gzipped);
+    }
+
+    // 🔹 Рядок АЗС з основної бази шукаємо в допоміжному потоці паралельно з роботою з базою клієнта:
+    //    для бази клієнта потрібен лише client_id, тож час відповіді ≈ найповільніша з двох гілок
+    QFuture<TerminalLookup> lookup = QtConcurrent::run(&fanOutPool, [this, clientId, terminalId]() {
+        TerminalLookup result;
+        QElapsedTimer timer;
+        timer.start();
+
+        QSqlQuery &sqlQuery = centralStatement("terminal_info", R"(
+            SELECT c.client_name, t.terminal_id, t.adress, t.phone
+            FROM terminals t
+            LEFT JOIN clients_list c ON c.client_id = t.client_id
+            WHERE t.client_id = :client_id AND t.terminal_id = :terminal_id
+        )");
+        sqlQuery.bindValue(":client_id", clientId);
+        sqlQuery.bindValue(":terminal_id", terminalId);
+
+        if (!sqlQuery.exec()) {
+            qWarning() << "⚠️ Помилка запиту до основної БД:" << sqlQuery.lastError().text();
+            result.error = R"({"error": "Database query failed"})";
+        } else if (!sqlQuery.next()) {
+            // 🔹 Якщо термінал не знайдено в базі — повертаємо помилку
+            qWarning() << "❌ Термінал не знайдено! client_id =" << clientId << ", terminal_id =" << terminalId;
+            result.error = R"({"error": "Terminal not found"})";
+        } else {
+            result.fields["client_name"] = sqlQuery.value("client_name").toString();
+            result.fields["terminal_id"] = sqlQuery.value("terminal_id").toInt();
+            result.fields["adress"] = sqlQuery.value("adress").toString();
+            result.fields["phone"] = sqlQuery.value("phone").toString();
+        }
+        result.elapsedNs = timer.nsecsElapsed();
+        return result;
+    });
+
+    // 🔹 Тим часом у цьому потоці: параметри, підключення з пулу та ТРК з пістолетами одним запитом
+    QByteArray clientError;
+    QJsonArray dispensersInfo;
+    auto clientDbParams = getClientDBParams(clientId);
+    if (!clientDbParams.has_value()) {
+        clientError = R"({"error": "Failed to get client DB parameters"})";
+    } else if (ClientDBLease clientLease = acquireTimed(clientPool, clientDbParams.value())) {
+        std::optional<QJsonArray> dispensers = getDispensersInfo(clientLease, terminalId);
+        if (dispensers.has_value()) {
+            dispensersInfo = std::move(dispensers.value());
+        } else {
+            clientError = R"({"error": "Database query failed"})";
+        }
+    } else {
+        clientError = R"({"error": "Failed to connect to client database"})";
+    }
+
+    const TerminalLookup terminal = lookup.result();
+    if (RequestTrace *trace = RequestTrace::current()) {
+        trace->add(RequestTrace::CentralDb, terminal.elapsedNs);
+    }
+
+    // 🔹 Помилки основної бази важливіші: без рядка АЗС дані з бази клієнта не потрібні
+    if (!terminal.error.isEmpty()) {
+        return QHttpServerResponse("application/json", terminal.error);
+    }
+    if (!clientError.isEmpty()) {
+        qWarning() << "⚠️ Помилка роботи з БД клієнта:" << clientError;
+        return QHttpServerResponse("application/json", clientError);
+    }
+
+    // 🔹 Формуємо відповідь із даними про АЗС та ТРК
+    QJsonObject response = terminal.fields;
+    response["client_db_connection"] = "OK";
+    response["dispensers_info"] = dispensersInfo;
+
+    return cachedJsonResponse(request, "/terminal_info", toJsonTimed(response));
+}
+
+
+
+/**
+ * @brief Обробляє запит `POST /terminal_info/batch` — інформація про багато АЗС клієнта за один запит
+ * @param request Тіло JSON: { "client_id": 1, "terminal_ids": [101, 102] } або { "client_id": 1, "terminal_ids": "all" }
+ * @return JSON-відповідь з об'єктом `terminals`, де ключ — terminal_id
+ */
+QHttpServerResponse Server::handleTerminalInfoBatch(const RequestContext &request) {
+    qDebug() << "📥 Запит отримано: /terminal_info/batch";
+
+    QJsonParseError parseError;
+    const QJsonDocument bodyDoc = QJsonDocument::fromJson(request.body, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !bodyDoc.isObject()) {
+        return QHttpServerResponse("application/json", R"({"error": "Invalid JSON body"})");
+    }
+
+    const QJsonObject body = bodyDoc.object();
+    if (!body.contains("client_id") || !body.contains("terminal_ids")) {
+        return QHttpServerResponse("application/json", R"({"error": "Missing parameters"})");
+    }
+
+    int clientId = 0;
+    if (!jsonToInt(body["client_id"], &clientId)) {
+        return QHttpServerResponse("application/json", R"({"error": "Invalid client_id parameter"})");
+    }
+    if (RequestTrace *trace = RequestTrace::current()) {
+        trace->setClientId(clientId);
+    }
+    const QJsonValue terminalIdsVal = body["terminal_ids"];
+    const bool allTerminals = terminalIdsVal.toString() == "all";
+    if (!allTerminals && !terminalIdsVal.isArray()) {
+        return QHttpServerResponse("application/json", R"({"error": "Invalid terminal_ids parameter"})");
+    }
+
+    const QJsonArray terminalIdsArray = terminalIdsVal.toArray();
+    if (terminalIdsArray.size() > kMaxBatchTerminals) {
+        return QHttpServerResponse("application/json", R"({"error": "Too many terminal_ids"})");
+    }
+
+    QSet<int> requestedIds;
+    for (const QJsonValue &idVal : terminalIdsArray) {
+        int terminalId = 0;
+        if (!jsonToInt(idVal, &terminalId)) {
+            return QHttpServerResponse("application/json", R"({"error": "Invalid terminal_ids parameter"})");
+        }
+        requestedIds.insert(terminalId);
+    }
+
+    // 🔹 Один запит до основної бази: усі АЗС клієнта
+    QSqlQuery &sqlQuery = centralStatement("terminal_info_batch", R"(
         SELECT c.client_name, t.terminal_id, t.adress, t.phone
         FROM terminals t
         LEFT JOIN clients_list c ON c.client_id = t.client_id
-        WHERE t.client_id = :client_id AND t.terminal_id = :terminal_id
+        WHERE t.client_id = :client_id
+        ORDER BY t.terminal_id
     )");
     sqlQuery.bindValue(":client_id", clientId);
-    sqlQuery.bindValue(":terminal_id", terminalId);
 
-    if (!sqlQuery.exec()) {
+    if (!execTimed(sqlQuery, RequestTrace::CentralDb)) {
         qWarning() << "⚠️ Помилка запиту до основної БД:" << sqlQuery.lastError().text();
         return QHttpServerResponse("application/json", R"({"error": "Database query failed"})");
     }
 
-    // 🔹 Якщо термінал не знайдено в базі — повертаємо помилку
-    if (!sqlQuery.next()) {
-        qWarning() << "❌ Термінал не знайдено! client_id =" << clientId << ", terminal_id =" << terminalId;
-        return QHttpServerResponse("application/json", R"({"error": "Terminal not found"})");
+    QString clientName;
+    QList<int> terminalIds;
+    QHash<int, QJsonObject> terminals;
+    while (sqlQuery.next()) {
+        const int terminalId = sqlQuery.value("terminal_id").toInt();
+        if (!allTerminals && !requestedIds.contains(terminalId)) {
+            continue;
+        }
+        clientName = sqlQuery.value("client_name").toString();
+
+        QJsonObject terminal;
+        terminal["terminal_id"] = terminalId;
+        terminal["adress"] = sqlQuery.value("adress").toString();
+        terminal["phone"] = sqlQuery.value("phone").toString();
+        terminals.insert(terminalId, terminal);
+        terminalIds.append(terminalId);
+    }
+
+    QJsonArray notFound;
+    for (int terminalId : std::as_const(requestedIds)) {
+        if (!terminals.contains(terminalId)) {
+            notFound.append(terminalId);
+        }
     }
 
-    // 🔹 Формуємо базову відповідь із даними про АЗС
     QJsonObject response;
-    response["client_name"] = sqlQuery.value("client_name").toString();
-    response["terminal_id"] = sqlQuery.value("terminal_id").toInt();
-    response["adress"] = sqlQuery.value("adress").toString();
-    response["phone"] = sqlQuery.value("phone").toString();
+    response["client_id"] = clientId;
+    response["client_name"] = clientName;
+    response["not_found"] = notFound;
+
+    if (terminalIds.isEmpty()) {
+        response["terminals"] = QJsonObject();
+        return jsonResponse(request, "/terminal_info", toJsonTimed(response));
+    }
 
     // 🔹 Отримуємо параметри підключення до БД клієнта
     auto clientDbParams = getClientDBParams(clientId);
@@ -260,37 +1219,106 @@ QHttpServerResponse Server::handleTerminalInfo(const QHttpServerRequest &request
         return QHttpServerResponse("application/json", R"({"error": "Failed to get client DB parameters"})");
     }
 
-    // 🔹 Підключаємося до бази даних клієнта
-    if (!connectToClientDatabase(clientDbParams.value())) {
+    // 🔹 Беремо підключення до бази даних клієнта з пулу
+    ClientDBLease clientLease = acquireTimed(clientPool, clientDbParams.value());
+    if (!clientLease) {
         qWarning() << "⚠️ Помилка підключення до БД клієнта!";
         return QHttpServerResponse("application/json", R"({"error": "Failed to connect to client database"})");
     }
 
-    QString connectionName = QString("clientDB_%1").arg(clientDbParams->server);
-    QSqlDatabase clientDB = QSqlDatabase::database(connectionName);
+    // 🔹 ТРК разом з пістолетами — один запит з IN (...) на кожні 500 АЗС замість запитів на кожну АЗС
+    const std::optional<QHash<int, QJsonArray>> dispensers = getDispensersInfoBatch(clientLease, terminalIds);
+    if (!dispensers.has_value()) {
+        return QHttpServerResponse("application/json", R"({"error": "Database query failed"})");
+    }
+    const QHash<int, QJsonArray> &dispensersByTerminal = dispensers.value();
 
-    // 🔹 Отримуємо ТРК та пістолети
-    QJsonArray dispensersInfo = getDispensersInfo(clientDB, terminalId);
-    QJsonObject pumpsGroupedByDispenser = getPumpsInfo(clientDB, terminalId);
+    QJsonObject terminalsObj;
+    for (int terminalId : std::as_const(terminalIds)) {
+        QJsonObject terminal = terminals.value(terminalId);
+        terminal["dispensers_info"] = dispensersByTerminal.value(terminalId);
+        terminalsObj[QString::number(terminalId)] = terminal;
+    }
 
-    // 🔹 Додаємо `pumps_info` у відповідні `dispenser_id`
-    QJsonArray updatedDispensersInfo;
-    for (const QJsonValue &dispenserVal : dispensersInfo) {
-        QJsonObject dispenserObj = dispenserVal.toObject();
-        int dispenserId = dispenserObj["dispenser_id"].toInt();
+    response["client_db_connection"] = "OK";
+    response["terminals"] = terminalsObj;
 
-        if (pumpsGroupedByDispenser.contains(QString::number(dispenserId))) {
-            dispenserObj["pumps_info"] = pumpsGroupedByDispenser[QString::number(dispenserId)];
-        }
+    qDebug() << "✅ Пакетний запит /terminal_info/batch, АЗС:" << terminalIds.size();
+    return jsonResponse(request, "/terminal_info", toJsonTimed(response));
+}
 
-        updatedDispensersInfo.append(dispenserObj);
+
+/**
+ * @brief Отримує ТРК з пістолетами для однієї АЗС одним запитом
+ * @param clientLease Орендоване підключення до бази клієнта
+ * @param terminalId ID АЗС
+ * @return JSON-масив ТРК з вкладеними `pumps_info`; std::nullopt, якщо запит не вдався
+ *         (порожній масив — АЗС без ТРК, його можна кешувати)
+ */
+std::optional<QJsonArray> Server::getDispensersInfo(ClientDBLease &clientLease, int terminalId) {
+    // ?? Перевіряємо, що БД відкрита
+    if (!clientLease.database().isOpen()) {
+        qCritical() << "? База даних клієнта не відкрита!";
+        return std::nullopt;
     }
 
-    // 🔹 Додаємо дані про підключення до БД клієнта
-    response["client_db_connection"] = "OK";
-    response["dispensers_info"] = updatedDispensersInfo;
+    static const QString sql = dispensersWithPumpsSql("= ?");
+    QSqlQuery &query = clientLease.statement("dispensers_with_pumps", sql);
+    query.addBindValue(terminalId);
+    query.addBindValue(terminalId);
+
+    if (!execClientTimed(query, clientLease, metrics)) {
+        qWarning() << "?? Помилка запиту інформації по ТРК та пістолетам:" << query.lastError().text();
+        qWarning() << "?? SQL-запит:" << query.lastQuery();
+        clientLease.invalidate();
+        return std::nullopt;
+    }
+
+    QJsonArray dispensers = buildDispensersWithPumps(query).value(terminalId);
+    if (clientFetchFailed(query, clientLease)) {
+        return std::nullopt;
+    }
+    qDebug() << "✅ Отримано інформацію про ТРК, кількість:" << dispensers.size();
+    return dispensers;
+}
+
+/**
+ * @brief Отримує ТРК з пістолетами для багатьох АЗС клієнта
+ * @param clientLease Орендоване підключення до бази клієнта
+ * @param terminalIds Список ID АЗС
+ * @return Масиви ТРК (з `pumps_info`), згруповані за terminal_id; std::nullopt, якщо хоч одна частина не вдалася
+ */
+std::optional<QHash<int, QJsonArray>> Server::getDispensersInfoBatch(ClientDBLease &clientLease,
+                                                                    const QList<int> &terminalIds) {
+    QHash<int, QJsonArray> dispensersByTerminal;
+
+    for (qsizetype offset = 0; offset < terminalIds.size(); offset += kInListChunkSize) {
+        const QList<int> chunk = terminalIds.mid(offset, kInListChunkSize);
+
+        // 🔹 Список доповнюється останнім ID до розміру кошика — дублікати в IN (...) не впливають на результат
+        const qsizetype bucket = inListBucket(chunk.size());
+        QSqlQuery &query = clientLease.statement(
+            QString("dispensers_with_pumps_in_%1").arg(bucket),
+            dispensersWithPumpsSql(QString("IN (%1)").arg(inPlaceholders(bucket))));
+        for (int pass = 0; pass < 2; ++pass) {
+            for (qsizetype i = 0; i < bucket; ++i) {
+                query.addBindValue(chunk.at(qMin(i, chunk.size() - 1)));
+            }
+        }
+
+        if (!execClientTimed(query, clientLease, metrics)) {
+            qWarning() << "⚠️ Помилка запиту інформації по ТРК та пістолетам:" << query.lastError().text();
+            clientLease.invalidate();
+            return std::nullopt;
+        }
+
+        dispensersByTerminal.insert(buildDispensersWithPumps(query));
+        if (clientFetchFailed(query, clientLease)) {
+            return std::nullopt;
+        }
+    }
 
-    return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+    return dispensersByTerminal;
 }
 
 
@@ -301,8 +1329,8 @@ QHttpServerResponse Server::handleTerminalInfo(const QHttpServerRequest &request
  * @param terminalId ID терміналу
  * @return JSON-масив з інформацією про каси
  */
-QHttpServerResponse Server::handlePosInfo(const QHttpServerRequest &request) {
-    QUrlQuery query(request.query());  // Змінна для параметрів запиту
+QHttpServerResponse Server::handlePosInfo(const RequestContext &request) {
+    const QUrlQuery &query = request.query;  // Змінна для параметрів запиту
     qDebug() << "📥 Запит отримано: /pos_info";
 
     if (!query.hasQueryItem("client_id") || !query.hasQueryItem("terminal_id")) {
@@ -319,18 +1347,15 @@ QHttpServerResponse Server::handlePosInfo(const QHttpServerRequest &request) {
         return QHttpServerResponse("application/json", R"({"error": "Failed to get client DB parameters"})");
     }
 
-    // 🔹 Підключаємося до бази даних клієнта
-    if (!connectToClientDatabase(clientDbParams.value())) {
+    // 🔹 Беремо підключення до бази даних клієнта з пулу
+    ClientDBLease clientLease = acquireTimed(clientPool, clientDbParams.value());
+    if (!clientLease) {
         qWarning() << "⚠️ Помилка підключення до БД клієнта!";
         return QHttpServerResponse("application/json", R"({"error": "Failed to connect to client database"})");
     }
 
-    QString connectionName = QString("clientDB_%1").arg(clientDbParams->server);
-    QSqlDatabase clientDB = QSqlDatabase::database(connectionName);
-
     // 🔹 Виконуємо SQL-запит
-    QSqlQuery sqlQuery(clientDB);  // ✅ Оновлена назва змінної
-    QString sql = QString(R"(
+    QSqlQuery &sqlQuery = clientLease.statement("pos_info", R"(
         WITH RankedVersions AS (
             SELECT
                 a.terminal_id,
@@ -353,92 +1378,286 @@ QHttpServerResponse Server::handlePosInfo(const QHttpServerRequest &request) {
             ON z.terminal_id = v.terminal_id
             AND z.pos_id = v.pos_id
             AND v.rn = 1
-        WHERE z.terminal_id = %1
+        WHERE z.terminal_id = :terminalId
           AND z.shift_id = (
               SELECT MAX(shift_id)
               FROM SHIFTS
-              WHERE terminal_id = %1
+              WHERE terminal_id = :terminalId
                 AND isclose = 'T'
           )
         ORDER BY z.pos_id;
-    )").arg(terminalId);
+    )");
+    sqlQuery.bindValue(":terminalId", terminalId);
 
-    if (!sqlQuery.exec(sql)) {
+    if (!execClientTimed(sqlQuery, clientLease, metrics)) {
         qWarning() << "❌ Помилка виконання SQL-запиту:" << sqlQuery.lastError().text();
+        clientLease.invalidate();
         return QHttpServerResponse("application/json", R"({"error": "Database query failed"})");
     }
 
-    // 🔹 Формуємо JSON-відповідь
-    QJsonArray posInfoArray;
+    // 🔹 Формуємо JSON-відповідь прямо з курсора
+    RequestTrace::Scope timing(RequestTrace::Serialize);
+    JsonWriter writer;
+    writer.beginObject().key("pos_info").beginArray();
     while (sqlQuery.next()) {
-        QJsonObject posInfo;
-        posInfo["pos_id"] = sqlQuery.value("pos_id").toInt();
-        posInfo["factorynumber"] = sqlQuery.value("factorynumber").toString();
-        posInfo["regnumber"] = sqlQuery.value("regnumber").toString();
-
-        if (!sqlQuery.value("pos_version").isNull()) {
-            posInfo["pos_version"] = sqlQuery.value("pos_version").toString();
+        writer.beginObject()
+            .field("pos_id", sqlQuery.value(0).toInt())
+            .field("factorynumber", sqlQuery.value(1).toString())
+            .field("regnumber", sqlQuery.value(2).toString());
+
+        // 🔹 Версії без даних у відповідь не потрапляють
+        static const char *const versionFields[] = {"pos_version", "db_version", "posterm_version"};
+        for (int i = 0; i < 3; ++i) {
+            const QVariant version = sqlQuery.value(3 + i);
+            if (!version.isNull()) {
+                writer.field(versionFields[i], version.toString());
+            }
         }
-        if (!sqlQuery.value("db_version").isNull()) {
-            posInfo["db_version"] = sqlQuery.value("db_version").toString();
-        }
-        if (!sqlQuery.value("posterm_version").isNull()) {
-            posInfo["posterm_version"] = sqlQuery.value("posterm_version").toString();
-        }
-
-        posInfoArray.append(posInfo);
+        writer.endObject();
     }
+    writer.endArray().endObject();
 
-    // 🔹 Формуємо фінальну відповідь
-    QJsonObject response;
-    response["pos_info"] = posInfoArray;
-
-    return QHttpServerResponse("application/json", QJsonDocument(response).toJson());
+    if (clientFetchFailed(sqlQuery, clientLease)) {
+        return QHttpServerResponse("application/json", R"({"error": "Database query failed"})");
+    }
+    return jsonResponse(request, "/pos_info", writer.take());
 }
 
 
 /**
  * @brief Обробляє запит `/status`, повертає JSON
+ *
+ * З `deep=1` повертає стан основної бази та баз клієнтів (див. handleDeepStatus).
  * @return JSON-відповідь { "status": "ok" }
  */
-QHttpServerResponse Server::handleStatus() {
+QHttpServerResponse Server::handleStatus(const RequestContext &request) {
     qInfo() << "✅ Отримано запит на /status";
+    const QString deep = request.query.queryItemValue("deep");
+    if (deep == "1" || deep == "true") {
+        return handleDeepStatus(request);
+    }
+
     QJsonObject response;
     response["status"] = "ok";
     QByteArray jsonData = QJsonDocument(response).toJson(QJsonDocument::Compact);
     qInfo() << "✅ Відправляємо JSON-відповідь" << response;
-    QHttpServerResponse httpResponse("application/json; charset=utf-8", jsonData);
-    return httpResponse;
+    return jsonResponse(request, "/status", jsonData);
 }
 
 /**
- * @brief Обробляє запит `/clients`, повертає JSON
- * @return JSON-відповідь { "id": "Clent Name" }
+ * @brief Обробляє `/status?deep=1`: віддає останній знімок фонової перевірки баз
+ *
+ * Сам запит нічого не перевіряє, тож відповідає миттєво навіть при недоступній базі.
+ * Якщо основна база недоступна — `503`, щоб балансувальник зняв сервер з ротації.
  */
-QHttpServerResponse Server::handleData() {
-    QSqlQuery query(db);
-    if (!query.exec("SELECT client_id, client_name FROM clients_list WHERE isactive=1")) {
-        qCritical() << "? Database query failed:" << query.lastError().text();
-        return QHttpServerResponse("application/json", QByteArray(R"({"error": "Database query failed"})"));
+QHttpServerResponse Server::handleDeepStatus(const RequestContext &request) {
+    if (!healthMonitor->isEnabled()) {
+        return QHttpServerResponse("application/json", R"({"error": "Deep health check is disabled"})");
     }
 
-    QJsonArray results;
-    while (query.next()) {
-        QJsonObject obj;
-        obj["id"] = query.value(0).toInt();
-        obj["name"] = query.value(1).toString();
-        results.append(obj);
+    QByteArray jsonData = healthMonitor->snapshot();
+    if (jsonData.isEmpty()) {
+        jsonData = R"({"status": "pending"})";  // 🔹 Перша перевірка ще не завершилась
+    } else if (!healthMonitor->isCentralAlive()) {
+        QHttpServerResponse response("application/json; charset=utf-8", jsonData,
+                                     QHttpServerResponse::StatusCode::ServiceUnavailable);
+        addResponseHeader(response, "Cache-Control", config->getCacheControl("status").toUtf8());
+        return response;
     }
+    return jsonResponse(request, "/status", jsonData);
+}
+
+/**
+ * @brief Обробляє запит `/stats`, повертає статистику робочих потоків та пулу підключень
+ * @return JSON-відповідь з розділами `workers`, `client_db_pool`, `client_params_cache`, `response_cache`
+ */
+QHttpServerResponse Server::handleStats(const RequestContext &request) {
+    QJsonObject workers;
+    workers["max_threads"] = workerPool.maxThreadCount();
+    workers["active_threads"] = workerPool.activeThreadCount();
+    workers["pending_requests"] = pendingRequests.loadRelaxed();
+    workers["max_queue"] = maxQueue;
 
     QJsonObject response;
-    response["data"] = results;
+    response["workers"] = workers;
+    response["client_db_pool"] = clientPool->stats();
+    response["client_params_cache"] = paramsCache.stats();
+    response["response_cache"] = responseCache.stats();
+    response["logging"] = Config::loggingStats();
+    QByteArray jsonData = QJsonDocument(response).toJson(QJsonDocument::Compact);
+    return jsonResponse(request, "/stats", jsonData);
+}
+
+/**
+ * @brief Додає до тексту метрики одне значення Prometheus
+ * @param labels Мітки без дужок або порожній рядок
+ */
+static void appendSample(QByteArray &out, const char *name, const QByteArray &labels, double value) {
+    out += name;
+    if (!labels.isEmpty()) {
+        out += '{' + labels + '}';
+    }
+    out += ' ' + QByteArray::number(value, 'g', 15) + '\n';
+}
+
+/**
+ * @brief Додає заголовки `# HELP` та `# TYPE` метрики
+ */
+static void appendHeader(QByteArray &out, const char *name, const char *type, const char *help) {
+    out += QByteArray("# HELP ") + name + ' ' + help + "\n# TYPE " + name + ' ' + type + '\n';
+}
+
+/**
+ * @brief Обробляє запит `/metrics`, повертає метрики в текстовому форматі Prometheus
+ *
+ * Лічильники запитів і гістограми пишуться з Metrics; стан пулу, кешів, черги
+ * логів та робочих потоків береться з тих самих знімків, що й у `/stats`.
+ */
+QHttpServerResponse Server::handleMetrics() {
+    QByteArray out = metrics.render();
+
+    appendHeader(out, "palantir_workers_active", "gauge", "Зайняті робочі потоки");
+    appendSample(out, "palantir_workers_active", {}, workerPool.activeThreadCount());
+    appendHeader(out, "palantir_requests_pending", "gauge", "Запити в черзі та в обробці");
+    appendSample(out, "palantir_requests_pending", {}, pendingRequests.loadRelaxed());
+
+    const QJsonArray poolClients = clientPool->stats().value("clients").toArray();
+    const struct { const char *name; const char *type; const char *field; const char *help; } poolMetrics[] = {
+        {"palantir_client_db_pool_connections", "gauge", "total", "Відкриті підключення до бази клієнта"},
+        {"palantir_client_db_pool_in_use", "gauge", "in_use", "Підключення, видані обробникам"},
+        {"palantir_client_db_pool_idle", "gauge", "idle", "Вільні підключення в пулі"},
+        {"palantir_client_db_pool_waiting", "gauge", "waiting", "Запити, що чекають на підключення"},
+        {"palantir_client_db_connections_opened_total", "counter", "created", "Відкрито підключень до бази клієнта"},
+        {"palantir_client_db_open_failures_total", "counter", "open_failures", "Невдалі спроби підключення"},
+        {"palantir_client_db_wait_timeouts_total", "counter", "wait_timeouts", "Тайм-аути очікування підключення"},
+        {"palantir_client_db_breaker_trips_total", "counter", "breaker_trips", "Розмикання запобіжника"},
+        {"palantir_client_db_breaker_rejections_total", "counter", "breaker_rejections", "Запити, відхилені розімкненим запобіжником"},
+    };
+    for (const auto &metric : poolMetrics) {
+        appendHeader(out, metric.name, metric.type, metric.help);
+        for (const QJsonValue &value : poolClients) {
+            const QJsonObject client = value.toObject();
+            appendSample(out, metric.name, "client=\"" + Metrics::label(client["connection"].toString()) + '"',
+                         client[metric.field].toDouble());
+        }
+    }
+
+    // 🔹 Стан запобіжника: 0 — closed, 1 — open, 2 — half_open
+    appendHeader(out, "palantir_client_db_breaker_state", "gauge", "Стан запобіжника бази клієнта (0 closed, 1 open, 2 half_open)");
+    for (const QJsonValue &value : poolClients) {
+        const QJsonObject client = value.toObject();
+        const QString breaker = client["breaker"].toString();
+        appendSample(out, "palantir_client_db_breaker_state", "client=\"" + Metrics::label(client["connection"].toString()) + '"',
+                     breaker == "open" ? 1 : breaker == "half_open" ? 2 : 0);
+    }
+
+    const struct { const char *cache; QJsonObject stats; } caches[] = {
+        {"client_params", paramsCache.stats()},
+        {"response", responseCache.stats()},
+    };
+    appendHeader(out, "palantir_cache_hits_total", "counter", "Влучання в кеш");
+    for (const auto &cache : caches) {
+        appendSample(out, "palantir_cache_hits_total", QByteArray("cache=\"") + cache.cache + '"', cache.stats["hits"].toDouble());
+    }
+    appendHeader(out, "palantir_cache_misses_total", "counter", "Промахи кешу");
+    for (const auto &cache : caches) {
+        appendSample(out, "palantir_cache_misses_total", QByteArray("cache=\"") + cache.cache + '"', cache.stats["misses"].toDouble());
+    }
+    appendHeader(out, "palantir_cache_hit_ratio", "gauge", "Частка влучань у кеш з моменту запуску");
+    for (const auto &cache : caches) {
+        const double hits = cache.stats["hits"].toDouble();
+        const double total = hits + cache.stats["misses"].toDouble();
+        appendSample(out, "palantir_cache_hit_ratio", QByteArray("cache=\"") + cache.cache + '"', total > 0 ? hits / total : 0.0);
+    }
+    appendHeader(out, "palantir_cache_entries", "gauge", "Записи в кеші");
+    for (const auto &cache : caches) {
+        appendSample(out, "palantir_cache_entries", QByteArray("cache=\"") + cache.cache + '"', cache.stats["entries"].toDouble());
+    }
+
+    const QJsonObject logging = Config::loggingStats();
+    if (!logging.isEmpty()) {
+        appendHeader(out, "palantir_log_queue_depth", "gauge", "Повідомлення в черзі логів");
+        appendSample(out, "palantir_log_queue_depth", {}, logging["queue_depth"].toDouble());
+        appendHeader(out, "palantir_log_queue_capacity", "gauge", "Розмір черги логів");
+        appendSample(out, "palantir_log_queue_capacity", {}, logging["queue_capacity"].toDouble());
+        appendHeader(out, "palantir_log_dropped_total", "counter", "Повідомлення, втрачені через переповнену чергу");
+        appendSample(out, "palantir_log_dropped_total", {}, logging["dropped"].toDouble());
+    }
+
+    return QHttpServerResponse("text/plain; version=0.0.4; charset=utf-8", out);
+}
+
+/**
+ * @brief Обробляє запит `POST /client_params/invalidate`, скидає кеш параметрів підключення
+ * @param request Запит з необов'язковим `client_id`; без нього скидається весь кеш
+ * @return JSON-відповідь { "invalidated": <client_id> | "all" }
+ */
+QHttpServerResponse Server::handleInvalidateClientParams(const RequestContext &request) {
+    QJsonObject response;
+    if (request.query.hasQueryItem("client_id")) {
+        bool ok = false;
+        int clientId = request.query.queryItemValue("client_id").toInt(&ok);
+        if (!ok) {
+            return QHttpServerResponse("application/json", R"({"error": "Invalid client_id parameter"})");
+        }
+        paramsCache.invalidate(clientId);
+        response["invalidated"] = clientId;
+        qInfo() << "🔸 Скинуто кеш параметрів підключення для client_id =" << clientId;
+    } else {
+        paramsCache.invalidateAll();
+        response["invalidated"] = "all";
+        qInfo() << "🔸 Скинуто весь кеш параметрів підключення";
+    }
 
     QByteArray jsonData = QJsonDocument(response).toJson(QJsonDocument::Compact);
+    return QHttpServerResponse("application/json; charset=utf-8", jsonData);
+}
+
+/**
+ * @brief Обробляє запит `/clients`, повертає JSON
+ *
+ * Зі `stream=1` або `Accept: application/x-ndjson` рядки віддаються частинами.
+ * @return JSON-відповідь { "id": "Clent Name" }
+ */
+void Server::handleData(const RequestContext &request, ResponseStream &stream) {
+    ListPage page;
+    QByteArray pageError;
+    if (!parseListPage(request.query, kClientsList, config->getServerMaxPageSize(), &page, &pageError)) {
+        stream.send(QHttpServerResponse("application/json", pageError));
+        return;
+    }
+
+    QSqlQuery &query = centralStatement(listStatementName(kClientsList, page), listSql(kClientsList, page));
+    bindListQuery(query, page, {});
+    if (!execTimed(query, RequestTrace::CentralDb)) {
+        qCritical() << "? Database query failed:" << query.lastError().text();
+        stream.send(QHttpServerResponse("application/json", QByteArray(R"({"error": "Database query failed"})")));
+        return;
+    }
+
+    if (request.wantsStream()) {
+        stream.begin();
+        const QByteArray tail = writeList(query, kClientsList, page, request.wantsNdjson(), &stream);
+        if (query.lastError().isValid()) {
+            qCritical() << "? Database fetch failed:" << query.lastError().text();
+            stream.fail(QHttpServerResponse("application/json", QByteArray(R"({"error": "Database query failed"})")));
+            return;
+        }
+        stream.write(tail);
+        stream.end();
+        return;
+    }
 
-    // Створюємо коректну HTTP-відповідь із заголовком UTF-8
-    QHttpServerResponse httpResponse("application/json; charset=utf-8", jsonData);
+    // 🔹 Рядки курсора пишемо одразу в JSON-буфер, без проміжного QJsonArray
+    QByteArray jsonData = writeList(query, kClientsList, page, false, nullptr);
+    if (query.lastError().isValid()) {
+        qCritical() << "? Database fetch failed:" << query.lastError().text();
+        stream.send(QHttpServerResponse("application/json", QByteArray(R"({"error": "Database query failed"})")));
+        return;
+    }
 
-    return httpResponse;
+    // Створюємо коректну HTTP-відповідь із заголовком UTF-8, ETag та Cache-Control
+    stream.send(jsonResponse(request, "/clients", jsonData));
 }
 
 
@@ -447,12 +1666,11 @@ QHttpServerResponse Server::handleData() {
  * @return JSON-відповідь { "id": "Clent Name" }
  */
 
-QHttpServerResponse Server::handleDataById(int clientId) {
-    QSqlQuery query(db);
-    query.prepare("SELECT client_id, client_name FROM clients_list WHERE client_id = :id");
+QHttpServerResponse Server::handleDataById(int clientId, const RequestContext &request) {
+    QSqlQuery &query = centralStatement("client_by_id", "SELECT client_id, client_name FROM clients_list WHERE client_id = :id");
     query.bindValue(":id", clientId);
 
-    if (!query.exec()) {
+    if (!execTimed(query, RequestTrace::CentralDb)) {
         qCritical() << "Database query failed:" << query.lastError().text();
         return QHttpServerResponse("application/json", QByteArray(R"({"error": "Database query failed"})"));
     }
@@ -467,164 +1685,343 @@ QHttpServerResponse Server::handleDataById(int clientId) {
     response["id"] = query.value(0).toInt();
     response["name"] = query.value(1).toString();
 
-    QByteArray jsonData = QJsonDocument(response).toJson(QJsonDocument::Compact);
+    QByteArray jsonData = toJsonTimed(response);
 
-    QHttpServerResponse httpResponse("application/json; charset=utf-8", jsonData);
-    return httpResponse;
+    return jsonResponse(request, "/clients", jsonData);
 }
 
 
 /**
- * @brief Отримує параметри підключення до бази даних клієнта
- * @param clientID ID клієнта
- * @return std::optional<ClientDBParams> - Параметри підключення або порожній об'єкт, якщо не вдалося отримати дані
+ * @brief Формує параметри підключення з рядка `clients_settings` та розшифровує пароль
  */
-std::optional<ClientDBParams> Server::getClientDBParams(int clientID) {
-    QSqlQuery query;
-    query.prepare("SELECT client_db_server, client_db_port, client_db_file, "
-                  "client_db_user, client_db_pass FROM clients_settings WHERE client_id = :clientID");
-    query.bindValue(":clientID", clientID);
-
-    if (!query.exec()) {
-        qCritical() << "? Помилка виконання SQL-запиту:" << query.lastError().text();
-        return std::nullopt;
-    }
-
-    if (!query.next()) {
-        qWarning() << "?? Немає даних для client_id =" << clientID;
-        return std::nullopt;
-    }
-
+static ClientDBParams clientDBParamsFromQuery(const QSqlQuery &query) {
     ClientDBParams params;
-    params.server = query.value(0).toString();
-    params.port = query.value(1).toInt();
-    params.database = query.value(2).toString();
-    params.username = query.value(3).toString();
+    params.server = query.value("client_db_server").toString();
+    params.port = query.value("client_db_port").toInt();
+    params.database = query.value("client_db_file").toString();
+    params.username = query.value("client_db_user").toString();
     // ?? Дешифруємо пароль перед збереженням
-    CriptPass criptPass;
-    QString encryptedPass = query.value(4).toString();
-    params.password = criptPass.decryptPassword(encryptedPass);
-
-    qInfo() << "? Отримані параметри підключення для client_id =" << clientID
-            << "\n  Сервер:" << params.server
-            << "\n  Порт:" << params.port
-            << "\n  Файл БД:" << params.database
-            << "\n  Користувач:" << params.username
-            << "\n  Пароль:" << params.password;
-
+    QString encryptedPass = query.value("client_db_pass").toString();
+    params.password = CriptPass::decryptPassword(encryptedPass);
     return params;
 }
 
+// 🔹 Опис зведеного маршруту /fleet/*: один запит до бази кожного клієнта по всіх його АЗС
+struct FleetSpec {
+    const char *name;      // ім'я в реєстрі підготовлених запитів
+    const char *arrayKey;  // назва масиву рядків у записі клієнта
+    const char *sql;
+    void (*writeRow)(JsonWriter &writer, const QSqlQuery &query);
+};
+
+static const FleetSpec kFleetReservoirs = {
+    "fleet_reservoirs", "reservoirs",
+    R"(
+        SELECT t.terminal_id, t.tank_id, t.fuel_id, f.shortname, f.name, t.maxvalue, t.minvalue,
+               t.deadmax, t.deadmin, t.tubeamount
+        FROM tanks t
+        LEFT JOIN fuels f ON f.fuel_id = t.fuel_id
+        WHERE t.isactive = 'T'
+        ORDER BY t.terminal_id, t.tank_id
+    )",
+    [](JsonWriter &writer, const QSqlQuery &query) {
+        writer.field("terminal_id", query.value(0).toInt())
+            .field("tank_id", query.value(1).toInt())
+            .field("fuel_id", query.value(2).toInt())
+            .field("shortname", query.value(3).toString())
+            .field("name", query.value(4).toString())
+            .field("maxvalue", query.value(5).toInt())
+            .field("minvalue", query.value(6).toInt())
+            .field("deadmax", query.value(7).toInt())
+            .field("deadmin", query.value(8).toInt())
+            .field("tubeamount", query.value(9).toInt());
+    }};
+
+static const FleetSpec kFleetPosVersions = {
+    "fleet_pos_versions", "pos_versions",
+    R"(
+        WITH RankedVersions AS (
+            SELECT
+                a.terminal_id,
+                a.pos_id,
+                a.pos_version,
+                a.db_version,
+                a.posterm_version,
+                ROW_NUMBER() OVER (PARTITION BY a.terminal_id, a.pos_id ORDER BY a.build_date DESC) AS rn
+            FROM APP_VERSION a
+        )
+        SELECT terminal_id, pos_id,
+               NULLIF(pos_version, '') AS pos_version,
+               NULLIF(db_version, '') AS db_version,
+               NULLIF(posterm_version, '') AS posterm_version
+        FROM RankedVersions
+        WHERE rn = 1
+        ORDER BY terminal_id, pos_id
+    )",
+    [](JsonWriter &writer, const QSqlQuery &query) {
+        writer.field("terminal_id", query.value(0).toInt()).field("pos_id", query.value(1).toInt());
+        // 🔹 Як і в /pos_info, версії без даних у відповідь не потрапляють
+        static const char *const versionFields[] = {"pos_version", "db_version", "posterm_version"};
+        for (int i = 0; i < 3; ++i) {
+            const QVariant version = query.value(2 + i);
+            if (!version.isNull()) {
+                writer.field(versionFields[i], version.toString());
+            }
+        }
+    }};
+
+// 🔹 Спільний стан зведеного запиту: задачі пишуть результат у свій запис, обробник чекає на всі
+struct FleetJob {
+    struct Client {
+        int clientId = 0;
+        QString clientName;
+        ClientDBParams params;
+        bool started = false;
+        bool done = false;
+        bool timedOut = false;
+        QElapsedTimer startTimer;
+        QByteArray rows;   // JSON-масив рядків
+        QByteArray error;  // текст помилки, якщо запит не вдався
+    };
+
+    QMutex mutex;
+    QWaitCondition changed;
+    QList<Client> clients;
+    bool abandoned = false;  // обробник уже відповів; задачі, що ще не почались, пропускаються
+};
+
 /**
- * @brief Підключається до бази даних клієнта з переданими параметрами
- * @param params Параметри підключення до БД клієнта
- * @return true, якщо підключення успішне, інакше false
+ * @brief Виконує запит зведеного маршруту в базі одного клієнта (у потоці fleetPool)
+ * @return JSON-масив рядків або порожній масив байтів з текстом помилки в error
  */
-std::optional<QString> Server::connectToClientDatabase(const ClientDBParams &params) {
-    QString connectionName = QString("clientDB_%1").arg(params.server);
-
-    if (QSqlDatabase::contains(connectionName)) {
-        QSqlDatabase existingDb = QSqlDatabase::database(connectionName);
-        if (existingDb.isOpen()) {
-            qDebug() << "🔸 Використовуємо вже відкрите підключення:" << connectionName;
-            return connectionName;
-        }
+static QByteArray fetchFleetRows(ClientDBPool *pool, Metrics &metrics, const FleetSpec &spec,
+                                 const ClientDBParams &params, QByteArray *error) {
+    ClientDBLease clientLease = pool->acquire(params);
+    if (!clientLease) {
+        *error = "Failed to connect to client database";
+        return QByteArray();
     }
 
-    QSqlDatabase clientDB = QSqlDatabase::addDatabase("QIBASE", connectionName);
-    clientDB.setHostName(params.server);
-    clientDB.setPort(params.port);
-    clientDB.setDatabaseName(params.database);
-    clientDB.setUserName(params.username);
-    clientDB.setPassword(params.password);
+    QSqlQuery &query = clientLease.statement(spec.name, spec.sql);
+    if (!execClientTimed(query, clientLease, metrics)) {
+        qWarning() << "❌ Помилка виконання SQL-запиту" << spec.name << ":" << query.lastError().text();
+        clientLease.invalidate();
+        *error = "Database query failed";
+        return QByteArray();
+    }
 
-    if (!clientDB.open()) {
-        qCritical() << "❌ Помилка підключення до бази клієнта:" << clientDB.lastError().text();
-        return std::nullopt;
+    JsonWriter writer;
+    writer.beginArray();
+    while (query.next()) {
+        writer.beginObject();
+        spec.writeRow(writer, query);
+        writer.endObject();
     }
+    writer.endArray();
 
-    qInfo() << "✅ Успішне підключення до бази клієнта:" << connectionName;
-    return connectionName;
+    // 🔹 Обірвана вибірка — помилка клієнта, а не неповний список зі статусом ok
+    if (clientFetchFailed(query, clientLease)) {
+        *error = "Database query failed";
+        return QByteArray();
+    }
+    return writer.take();
 }
 
+/**
+ * @brief Обробляє `/fleet/reservoirs` та `/fleet/pos_versions` — зведені дані по всіх активних клієнтах
+ *
+ * Бази клієнтів опитуються паралельно в пулі fleetPool (не більше `[Fleet] max_concurrency`
+ * одночасно). Клієнт, що не відповів за `client_timeout_ms` від початку свого запиту
+ * (або не встиг почати за `request_timeout_ms`), потрапляє у відповідь зі статусом `timeout`;
+ * помилки окремих клієнтів не зривають відповідь, а позначаються в записі клієнта.
+ * @param request Дані запиту
+ * @param route `/fleet/reservoirs` або `/fleet/pos_versions`
+ * @return JSON { "clients": [...], "clients_total": N, "clients_failed": M }
+ */
+QHttpServerResponse Server::handleFleet(const RequestContext &request, const QString &route) {
+    qDebug() << "📥 Запит отримано:" << route;
+    const FleetSpec &spec = route == "/fleet/pos_versions" ? kFleetPosVersions : kFleetReservoirs;
+
+    QSqlQuery &sqlQuery = centralStatement("fleet_clients", R"(
+        SELECT s.client_id, c.client_name, s.client_db_server, s.client_db_port, s.client_db_file,
+               s.client_db_user, s.client_db_pass
+        FROM clients_settings s
+        JOIN clients_list c ON c.client_id = s.client_id
+        WHERE c.isactive = 1
+        ORDER BY s.client_id
+    )");
+    if (!execTimed(sqlQuery, RequestTrace::CentralDb)) {
+        qWarning() << "⚠️ Помилка запиту до основної БД:" << sqlQuery.lastError().text();
+        return QHttpServerResponse("application/json", R"({"error": "Database query failed"})");
+    }
 
-
-QJsonArray Server::getDispensersInfo(QSqlDatabase &clientDB, int terminalId) {
-    QJsonArray dispensers;
-
-    // ?? Перевіряємо, що БД відкрита
-    if (!clientDB.isOpen()) {
-        qCritical() << "? База даних клієнта не відкрита!";
-        return dispensers;
+    auto job = std::make_shared<FleetJob>();
+    while (sqlQuery.next()) {
+        FleetJob::Client client;
+        client.clientId = sqlQuery.value("client_id").toInt();
+        client.clientName = sqlQuery.value("client_name").toString();
+        if (auto cached = paramsCache.get(client.clientId)) {
+            client.params = *cached;
+        } else {
+            client.params = clientDBParamsFromQuery(sqlQuery);
+            client.params.statementTimeoutMs = config->getClientStatementTimeoutMs(client.clientId);
+            paramsCache.put(client.clientId, client.params);
+        }
+        job->clients.append(client);
     }
 
-    qDebug() << "?? Поточна база даних:" << clientDB.connectionName() << clientDB.databaseName();
+    for (qsizetype i = 0; i < job->clients.size(); ++i) {
+        fleetPool.start([this, job, i, &spec]() {
+            ClientDBParams params;
+            {
+                QMutexLocker locker(&job->mutex);
+                if (job->abandoned) {
+                    return;
+                }
+                job->clients[i].started = true;
+                job->clients[i].startTimer.start();
+                params = job->clients[i].params;
+            }
+
+            QByteArray error;
+            QByteArray rows = fetchFleetRows(clientPool, metrics, spec, params, &error);
+
+            QMutexLocker locker(&job->mutex);
+            job->clients[i].done = true;
+            job->clients[i].rows = std::move(rows);
+            job->clients[i].error = std::move(error);
+            job->changed.wakeAll();
+        });
+    }
 
-    QSqlQuery query(clientDB);
-    query.prepare(R"(
-        SELECT d.dispenser_id, p.name, d.channelport, d.channelspeed, d.netaddress
-        FROM dispensers d
-        LEFT JOIN protocols p ON p.protocol_id = d.protocol_id
-        WHERE d.terminal_id = :terminalId AND d.isactive = 'T'
-          AND p.postype_id = (SELECT s.postype_id FROM POSS s WHERE s.terminal_id = :terminalId AND s.pos_id = 1)
-    )");
+    // 🔹 Чекаємо, поки кожен клієнт відповість або вичерпає свій час
+    const qint64 clientTimeoutMs = config->getFleetClientTimeoutMs();
+    const qint64 requestTimeoutMs = config->getFleetRequestTimeoutMs();
+    QElapsedTimer requestTimer;
+    requestTimer.start();
+
+    QMutexLocker locker(&job->mutex);
+    forever {
+        bool waiting = false;
+        qint64 nextCheckMs = requestTimeoutMs - requestTimer.elapsed();
+        for (FleetJob::Client &client : job->clients) {
+            if (client.done || client.timedOut) {
+                continue;
+            }
+            if (client.started) {
+                const qint64 left = clientTimeoutMs - client.startTimer.elapsed();
+                if (left <= 0) {
+                    client.timedOut = true;
+                    continue;
+                }
+                nextCheckMs = qMin(nextCheckMs, left);
+            } else if (requestTimer.elapsed() >= requestTimeoutMs) {
+                client.timedOut = true;
+                continue;
+            }
+            waiting = true;
+        }
+        if (!waiting) {
+            break;
+        }
+        job->changed.wait(&job->mutex, QDeadlineTimer(qMax<qint64>(1, nextCheckMs)));
+    }
+    job->abandoned = true;
+
+    RequestTrace::Scope timing(RequestTrace::Serialize);
+    int failed = 0;
+    JsonWriter writer;
+    writer.beginObject().key("clients").beginArray();
+    for (const FleetJob::Client &client : job->clients) {
+        writer.beginObject()
+            .field("client_id", client.clientId)
+            .field("client_name", client.clientName);
+        if (client.timedOut) {
+            writer.field("status", "timeout");
+            ++failed;
+        } else if (!client.error.isEmpty()) {
+            writer.field("status", "error").field("error", QString::fromUtf8(client.error));
+            ++failed;
+        } else {
+            writer.field("status", "ok").key(spec.arrayKey).raw(client.rows);
+        }
+        writer.endObject();
+    }
+    writer.endArray()
+        .field("clients_total", int(job->clients.size()))
+        .field("clients_failed", failed)
+        .endObject();
+    locker.unlock();
+
+    if (failed > 0) {
+        qWarning() << "⚠️" << route << ": не відповіли клієнтів —" << failed << "з" << job->clients.size();
+    }
+    return jsonResponse(request, route, writer.take());
+}
 
-    query.bindValue(":terminalId", terminalId);
+/**
+ * @brief Завантажує в кеш параметри підключення всіх клієнтів одним запитом
+ */
+void Server::warmUpClientParams() {
+    if (!paramsCache.isEnabled()) {
+        return;
+    }
 
-    if (!query.exec()) {
-        qWarning() << "?? Помилка запиту інформації по ТРК:" << query.lastError().text();
-        qWarning() << "?? SQL-запит:" << query.lastQuery();
-        return dispensers;
+    QSqlQuery query(db);
+    if (!query.exec("SELECT client_id, client_db_server, client_db_port, client_db_file, "
+                    "client_db_user, client_db_pass FROM clients_settings")) {
+        qWarning() << "⚠️ Не вдалося прогріти кеш параметрів клієнтів:" << query.lastError().text();
+        return;
     }
 
+    int count = 0;
     while (query.next()) {
-        QJsonObject disp;
-        disp["dispenser_id"] = query.value("dispenser_id").toInt();
-        disp["protocol"] = query.value("name").toString();
-        disp["port"] = query.value("channelport").toInt();
-        disp["speed"] = query.value("channelspeed").toInt();
-        disp["address"] = query.value("netaddress").toInt();
-        dispensers.append(disp);
+        const int clientId = query.value("client_id").toInt();
+        ClientDBParams params = clientDBParamsFromQuery(query);
+        params.statementTimeoutMs = config->getClientStatementTimeoutMs(clientId);
+        paramsCache.put(clientId, params);
+        ++count;
     }
-
-    return dispensers;
+    qInfo() << "✅ Кеш параметрів підключення прогріто, клієнтів:" << count;
 }
 
-QJsonObject Server::getPumpsInfo(QSqlDatabase &clientDB, int terminalId) {
-    QJsonObject pumpsGroupedByDispenser;
+/**
+ * @brief Отримує параметри підключення до бази даних клієнта
+ *
+ * Спочатку шукає в кеші; до основної бази звертається лише при промаху.
+ * @param clientID ID клієнта
+ * @return std::optional<ClientDBParams> - Параметри підключення або порожній об'єкт, якщо не вдалося отримати дані
+ */
+std::optional<ClientDBParams> Server::getClientDBParams(int clientID) {
+    if (auto cached = paramsCache.get(clientID)) {
+        return cached;
+    }
 
-    QString queryStr = QString(R"(
-        SELECT t.dispenser_id, t.trk_id AS pump_id, t.tank_id, f.shortname
-        FROM trks t
-        LEFT JOIN tanks s ON s.tank_id = t.tank_id
-        LEFT JOIN fuels f ON f.fuel_id = s.fuel_id
-        WHERE t.terminal_id = %1
-          AND s.terminal_id = %1
-          AND t.isactive = 'T'
-        ORDER BY t.dispenser_id, t.trk_id
-    )").arg(terminalId);
+    QSqlQuery &query = centralStatement("client_db_params",
+                                        "SELECT client_db_server, client_db_port, client_db_file, "
+                                        "client_db_user, client_db_pass FROM clients_settings WHERE client_id = :clientID");
+    query.bindValue(":clientID", clientID);
 
-    QSqlQuery query(clientDB);
-    if (!query.exec(queryStr)) {
-        qWarning() << "❌ Помилка запиту інформації по пістолетам:" << query.lastError().text();
-        qWarning() << "❌ SQL-запит:" << queryStr;
-        return pumpsGroupedByDispenser;
+    if (!execTimed(query, RequestTrace::CentralDb)) {
+        qCritical() << "? Помилка виконання SQL-запиту:" << query.lastError().text();
+        return std::nullopt;
     }
 
-    while (query.next()) {
-        int dispenserId = query.value("dispenser_id").toInt();
-        QJsonObject pump;
-        pump["pump_id"] = query.value("pump_id").toInt();
-        pump["tank_id"] = query.value("tank_id").toInt();
-        pump["fuel_shortname"] = query.value("shortname").toString();
-
-        // Додаємо пістолет до відповідного ТРК
-        QJsonArray pumpsArray = pumpsGroupedByDispenser[QString::number(dispenserId)].toArray();
-        pumpsArray.append(pump);
-        pumpsGroupedByDispenser[QString::number(dispenserId)] = pumpsArray;
+    if (!query.next()) {
+        qWarning() << "?? Немає даних для client_id =" << clientID;
+        return std::nullopt;
     }
 
-    qDebug() << "✅ Отримано інформацію про пістолети, кількість записів:" << pumpsGroupedByDispenser.size();
-    return pumpsGroupedByDispenser;
-}
+    ClientDBParams params = clientDBParamsFromQuery(query);
+    params.statementTimeoutMs = config->getClientStatementTimeoutMs(clientID);
+    paramsCache.put(clientID, params);
 
+    qInfo() << "? Отримані параметри підключення для client_id =" << clientID
+            << "\n  Сервер:" << params.server
+            << "\n  Порт:" << params.port
+            << "\n  Файл БД:" << params.database
+            << "\n  Користувач:" << params.username
+            << "\n  Пароль:" << params.password;
+
+    return params;
+}
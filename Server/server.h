@@ -5,16 +5,40 @@
 #include <QHttpServer>
 #include <QSqlDatabase>
 #include <QSqlQuery>
+#include <QThreadPool>
+#include <QFuture>
+#include <QUrlQuery>
+#include <QHostAddress>
+#include <QAtomicInt>
+#include <QThreadStorage>
+#include <functional>
 #include <optional>
 #include "../config.h"
+#include "clientdbparams.h"
+#include "clientdbpool.h"
+#include "clientparamscache.h"
+#include "responsecache.h"
+#include "statementcache.h"
+#include "responsestream.h"
+#include "metrics.h"
+#include "healthmonitor.h"
+#include <memory>
 
-// Структура з параметрами підключення до бази клієнта
-struct ClientDBParams {
-    QString server;
-    int port;
-    QString database;
-    QString username;
-    QString password;
+// Дані HTTP-запиту, скопійовані для обробки в робочому потоці
+struct RequestContext {
+    QUrlQuery query;
+    QByteArray body;
+    QByteArray ifNoneMatch;  // 🔹 Заголовок If-None-Match
+    QByteArray accept;       // 🔹 Заголовок Accept
+    QByteArray acceptEncoding;  // 🔹 Заголовок Accept-Encoding
+    QString route;           // 🔹 Шлях запиту
+    QByteArray requestId;    // 🔹 X-Request-Id клієнта або згенерований id
+    QHostAddress remoteAddress;  // 🔹 Адреса та порт клієнта — за ними знаходимо сокет потокової відповіді
+    quint16 remotePort = 0;
+
+    static RequestContext fromRequest(const QHttpServerRequest &request);
+    bool wantsNdjson() const;
+    bool wantsStream() const;
 };
 
 class Server : public QObject {
@@ -28,25 +52,59 @@ private:
     int port;
     Config *config;  // 🔹 Зберігаємо конфігурацію
     QSqlDatabase db;  // 🔹 Підключення до бази даних
+    ClientParamsCache paramsCache;  // 🔹 Кеш розшифрованих параметрів підключення до баз клієнтів
+    ResponseCache responseCache;    // 🔹 Кеш відповідей /terminal_info, /reservoirs_info, /azs_list
+    Metrics metrics;                // 🔹 Лічильники та гістограми для /metrics
+
+    QThreadStorage<StatementCache *> centralStatements;  // 🔹 Підготовлені запити основної бази для кожного потоку
+    QThreadPool workerPool;  // 🔹 Потоки, в яких виконуються обробники запитів
+    QThreadPool fanOutPool;  // 🔹 Потоки для незалежних запитів, що обробник виконує паралельно
+    QThreadPool fleetPool;   // 🔹 Потоки, що опитують бази клієнтів для /fleet/*
+    QAtomicInt pendingRequests;  // 🔹 Запити в черзі та в обробці
+    int maxQueue;
+    int compressionMinSize;  // 🔹 Тіла від цього розміру стискаються; 0 — стиснення вимкнено
+    int compressionLevel;
 
     bool connectToDatabase();  // 🔹 Метод для підключення до бази
+    QSqlDatabase centralDatabase();  // 🔹 Підключення до основної бази для поточного потоку
+    QSqlQuery &centralStatement(const QString &name, const QString &sql);  // 🔹 Підготовлений запит до основної бази
+    QFuture<QHttpServerResponse> dispatch(const RequestContext &request, std::function<QHttpServerResponse()> handler,
+                                          int timeoutMs = 0);
+    int clientRequestTimeoutMs(const RequestContext &request) const;
+    void dispatchStream(const RequestContext &request, std::shared_ptr<ResponseStream> stream,
+                        std::function<void(ResponseStream &)> handler);
+    std::shared_ptr<ResponseStream> makeStream(const RequestContext &request, const QString &route,
+                                               QHttpServerResponder &&responder);
+    QTcpSocket *requestSocket(const RequestContext &request) const;
+    QHttpServerResponse jsonResponse(const RequestContext &request, const QString &route,
+                                     const QByteArray &body, QByteArray etag = QByteArray(),
+                                     QByteArray gzipped = QByteArray());
+    QHttpServerResponse cachedJsonResponse(const RequestContext &request, const QString &route, const QByteArray &body);
+    QByteArray precompress(const QByteArray &body) const;
+    static QByteArray makeETag(const QByteArray &body);
     void setupRoutes();  // 🔹 Налаштування всіх маршрутів
-    QSqlDatabase clientDB; // підключення до БД клієнта
-    std::optional<QString> connectToClientDatabase(const ClientDBParams &params);
-    QJsonArray getDispensersInfo(QSqlDatabase &clientDB, int terminalId);
-    QJsonObject getPumpsInfo(QSqlDatabase &clientDB, int terminalId);
-
-
-    QHttpServerResponse handleStatus();                  // 🔹 Обробка `/status`
-    QHttpServerResponse handleData();                    // 🔹 Обробка `/data`
-    QHttpServerResponse handleDataById(int clientId);    // 🔹 Обробка `/data/<id>`
-    QHttpServerResponse handleTerminalInfo(const QHttpServerRequest &request); ///terminal_info
-    QHttpServerResponse handlePosInfo(const QHttpServerRequest &request);       //pos_info
-    QHttpServerResponse handleReservoirsInfo(const QHttpServerRequest &request); //Tank info
-    QHttpServerResponse handleAzsList(const QHttpServerRequest &request);       //AZS list
+    ClientDBPool *clientPool;  // 🔹 Пул підключень до баз клієнтів
+    std::unique_ptr<HealthMonitor> healthMonitor;  // 🔹 Фонова перевірка баз для /status?deep=1 (зупиняється раніше, ніж знищується пул)
+    std::optional<QJsonArray> getDispensersInfo(ClientDBLease &clientLease, int terminalId);
+    std::optional<QHash<int, QJsonArray>> getDispensersInfoBatch(ClientDBLease &clientLease, const QList<int> &terminalIds);
+
+
+    QHttpServerResponse handleStatus(const RequestContext &request);  // 🔹 Обробка `/status`
+    QHttpServerResponse handleDeepStatus(const RequestContext &request);  // 🔹 Обробка `/status?deep=1`
+    QHttpServerResponse handleStats(const RequestContext &request);   // 🔹 Обробка `/stats`
+    QHttpServerResponse handleMetrics();                              // 🔹 Обробка `/metrics`
+    QHttpServerResponse handleInvalidateClientParams(const RequestContext &request); // 🔹 `/client_params/invalidate`
+    void handleData(const RequestContext &request, ResponseStream &stream);          // 🔹 Обробка `/clients`
+    QHttpServerResponse handleDataById(int clientId, const RequestContext &request); // 🔹 Обробка `/data/<id>`
+    QHttpServerResponse handleTerminalInfo(const RequestContext &request); ///terminal_info
+    QHttpServerResponse handleTerminalInfoBatch(const RequestContext &request); ///terminal_info/batch
+    QHttpServerResponse handlePosInfo(const RequestContext &request);       //pos_info
+    QHttpServerResponse handleReservoirsInfo(const RequestContext &request); //Tank info
+    void handleAzsList(const RequestContext &request, ResponseStream &stream);  //AZS list
+    QHttpServerResponse handleFleet(const RequestContext &request, const QString &route);  // 🔹 `/fleet/reservoirs`, `/fleet/pos_versions`
     QJsonArray getPosInfo(QSqlDatabase &clientDB, int terminalId);
     std::optional<ClientDBParams> getClientDBParams(int clientID);
-    std::optional<QSqlDatabase> connectToClientDB(const ClientDBParams& params);
+    void warmUpClientParams();  // 🔹 Завантаження параметрів усіх клієнтів у кеш при старті
 };
 
 #endif // SERVER_H
@@ -0,0 +1,33 @@
+#include "statementcache.h"
+#include <QDebug>
+#include <QSqlError>
+
+/**
+ * @brief Повертає підготовлений запит з реєстру, готуючи його при першому зверненні
+ * @param db Підключення, якому належить реєстр
+ * @param name Ім'я запиту в реєстрі
+ * @param sql Текст запиту; якщо він змінився, запит готується заново
+ * @return Запит, готовий до bindValue()/exec(); якщо prepare() не вдався, exec() поверне помилку
+ */
+QSqlQuery &StatementCache::prepare(const QSqlDatabase &db, const QString &name, const QString &sql) {
+    auto it = statements.find(name);
+    if (it == statements.end()) {
+        it = statements.try_emplace(name, db).first;
+    }
+
+    Statement &stmt = it->second;
+    if (stmt.prepared && stmt.sql == sql) {
+        // 🔹 Закриваємо курсор попереднього виконання, план запиту залишається
+        stmt.query.finish();
+        return stmt.query;
+    }
+
+    stmt.query = QSqlQuery(db);
+    stmt.query.setForwardOnly(true);
+    stmt.sql = sql;
+    stmt.prepared = stmt.query.prepare(sql);
+    if (!stmt.prepared) {
+        qWarning() << "❌ Не вдалося підготувати запит" << name << ":" << stmt.query.lastError().text();
+    }
+    return stmt.query;
+}
@@ -0,0 +1,38 @@
+#ifndef STATEMENTCACHE_H
+#define STATEMENTCACHE_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <map>
+
+/**
+ * @brief Реєстр підготовлених запитів одного підключення
+ *
+ * Кожен іменований запит готується (prepare) один раз на підключення, далі
+ * лише перев'язуються параметри — Firebird не розбирає та не планує запит заново.
+ * Реєстр живе стільки ж, скільки підключення, і використовується лише потоком,
+ * якому належить підключення.
+ */
+class StatementCache {
+public:
+    StatementCache() = default;
+    StatementCache(const StatementCache &) = delete;
+    StatementCache &operator=(const StatementCache &) = delete;
+
+    QSqlQuery &prepare(const QSqlDatabase &db, const QString &name, const QString &sql);
+    void clear() { statements.clear(); }
+    int size() const { return int(statements.size()); }
+
+private:
+    struct Statement {
+        explicit Statement(const QSqlDatabase &db) : query(db) {}
+        QSqlQuery query;
+        QString sql;
+        bool prepared = false;
+    };
+
+    std::map<QString, Statement> statements;
+};
+
+#endif // STATEMENTCACHE_H
@@ -0,0 +1,111 @@
+/**
+ * @brief Замір швидкості AES (ціль `aes_bench`, у ctest не входить)
+ *
+ * Для кожної реалізації AesBackend, яку підтримує процесор.
+ * Малі дані — пароль бази клієнта: CriptPass (кешований розклад ключів) та QAESEncryption::Crypt
+ * (розгортання ключа на кожен виклик). Один блок — блоковий API на готовому розкладі ключів.
+ * Великі — 1 МіБ у ECB/CBC в обидва боки (МБ/с та нс/блок).
+ */
+#include "../Server/criptpass.h"
+#include "../Server/qaesencryption.h"
+#include "../Server/aesbackend.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+#include <QDebug>
+#include <cstring>
+
+namespace {
+
+constexpr int BlockSize = AesBackend::BlockSize;
+
+template <typename Fn>
+double nsPerIteration(qint64 iterations, Fn &&fn) {
+    QElapsedTimer timer;
+    timer.start();
+    for (qint64 i = 0; i < iterations; ++i) {
+        fn();
+    }
+    return double(timer.nsecsElapsed()) / double(iterations);
+}
+
+} // namespace
+
+int main() {
+    volatile quint8 sink = 0;  // не дає компілятору викинути виміряний код
+
+    const QByteArray key256 = QByteArray::fromHex("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4");
+    const QByteArray key128 = QByteArray::fromHex("2b7e151628aed2a6abf7158809cf4f3c");
+    const QByteArray iv = QByteArray::fromHex("000102030405060708090a0b0c0d0e0f");
+
+    for (AesBackend::Kind kind : {AesBackend::Portable, AesBackend::AesNi}) {
+        if (!AesBackend::isSupported(kind)) {
+            qInfo() << "🔸" << AesBackend::name(kind) << ": не підтримується цим процесором, пропускаємо";
+            continue;
+        }
+        AesBackend::setActive(kind);
+        qInfo().noquote() << QString("🔹 Реалізація %1").arg(AesBackend::name(kind));
+
+        const QString password = "masterkey123";
+        const QString encrypted = CriptPass::encryptPassword(password);
+        const QByteArray plain = password.toUtf8();
+        const qint64 passwordIterations = 20000;
+        const double encryptNs = nsPerIteration(passwordIterations, [&]() {
+            sink = sink ^ quint8(CriptPass::encryptPassword(password).size());
+        });
+        const double decryptNs = nsPerIteration(passwordIterations, [&]() {
+            sink = sink ^ quint8(CriptPass::decryptPassword(encrypted).size());
+        });
+        const double cryptNs = nsPerIteration(passwordIterations, [&]() {
+            sink = sink ^ quint8(QAESEncryption::Crypt(QAESEncryption::AES_256, QAESEncryption::CBC, plain, key256, iv).at(0));
+        });
+        qInfo().noquote() << QString("🔹 Пароль %1 байт: CriptPass шифрування %2 нс, розшифрування %3 нс; "
+                                     "QAESEncryption::Crypt %4 нс")
+                                 .arg(plain.size()).arg(encryptNs, 0, 'f', 0).arg(decryptNs, 0, 'f', 0).arg(cryptNs, 0, 'f', 0);
+
+        const QByteArray data(1 << 20, 'x');
+        const qint64 blocks = data.size() / BlockSize;
+        const auto mbPerSec = [&](double ns) { return double(data.size()) * 1000.0 / ns; };
+        const struct {
+            QAESEncryption::Aes level;
+            const char *name;
+            const QByteArray &key;
+        } levels[] = {{QAESEncryption::AES_128, "AES-128", key128}, {QAESEncryption::AES_256, "AES-256", key256}};
+        const struct {
+            QAESEncryption::Mode mode;
+            const char *name;
+        } modes[] = {{QAESEncryption::ECB, "ECB"}, {QAESEncryption::CBC, "CBC"}};
+
+        for (const auto &level : levels) {
+            for (const auto &mode : modes) {
+                QAESEncryption aes(level.level, mode.mode, QAESEncryption::ZERO);
+                quint8 schedule[AesBackend::MaxScheduleSize];
+                quint8 chain[BlockSize];
+                quint8 block[BlockSize] = {};
+                aes.expandKey(reinterpret_cast<const quint8 *>(level.key.constData()), schedule, true);
+                std::memcpy(chain, iv.constData(), sizeof(chain));
+                const double singleNs = nsPerIteration(1000000, [&]() {
+                    aes.encryptBlocks(schedule, chain, block, block, BlockSize);
+                });
+                sink = sink ^ block[0];
+
+                QByteArray cipher;
+                const double encryptBufferNs = nsPerIteration(4, [&]() {
+                    cipher = aes.encode(data, level.key, iv);
+                });
+                const double decryptBufferNs = nsPerIteration(4, [&]() {
+                    sink = sink ^ quint8(aes.decode(cipher, level.key, iv).at(0));
+                });
+                qInfo().noquote() << QString("🔹 %1-%2: 1 блок %3 нс; 1 МіБ шифрування %4 МБ/с (%5 нс/блок), "
+                                             "розшифрування %6 МБ/с (%7 нс/блок)")
+                                         .arg(level.name, mode.name)
+                                         .arg(singleNs, 0, 'f', 1)
+                                         .arg(mbPerSec(encryptBufferNs), 0, 'f', 0)
+                                         .arg(encryptBufferNs / double(blocks), 0, 'f', 2)
+                                         .arg(mbPerSec(decryptBufferNs), 0, 'f', 0)
+                                         .arg(decryptBufferNs / double(blocks), 0, 'f', 2);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,243 @@
+/**
+ * @brief Замір вибірки ТРК з пістолетами на живій базі клієнта (ціль `dispensers_bench`, у ctest не входить)
+ *
+ * Порівнює три способи для тих самих АЗС:
+ * - попередній: на кожну АЗС окремий запит ТРК і окремий запит пістолетів (2·N запитів)
+ *   та злиття через QJsonObject з ключами-рядками, як до переходу на один запит;
+ * - один впорядкований запит на АЗС (/terminal_info), підготовлений один раз;
+ * - один запит з IN (...) на весь список (/terminal_info/batch).
+ * Перед заміром результати порівнюються; розбіжність — код виходу 1.
+ *
+ * Приклад:
+ *   dispensers_bench --host 10.0.0.5 --database /data/client.fdb --user SYSDBA --password masterkey \
+ *                    --terminals 101,102,103 --iterations 50
+ */
+#include "../Server/dispensersquery.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+// 🔹 Попередній шлях /terminal_info: ТРК та пістолети окремими запитами, злиття за QString::number(dispenser_id)
+QJsonArray legacyDispensers(QSqlDatabase &db, int terminalId, bool *ok) {
+    QSqlQuery dispensersQuery(db);
+    dispensersQuery.prepare(R"(
+        SELECT d.dispenser_id, p.name, d.channelport, d.channelspeed, d.netaddress
+        FROM dispensers d
+        LEFT JOIN protocols p ON p.protocol_id = d.protocol_id
+        WHERE d.terminal_id = :terminalId AND d.isactive = 'T'
+          AND p.postype_id = (SELECT s.postype_id FROM POSS s WHERE s.terminal_id = :terminalId AND s.pos_id = 1)
+    )");
+    dispensersQuery.bindValue(":terminalId", terminalId);
+
+    QSqlQuery pumpsQuery(db);
+    pumpsQuery.prepare(R"(
+        SELECT t.dispenser_id, t.trk_id AS pump_id, t.tank_id, f.shortname
+        FROM trks t
+        LEFT JOIN tanks s ON s.tank_id = t.tank_id
+        LEFT JOIN fuels f ON f.fuel_id = s.fuel_id
+        WHERE t.terminal_id = :terminalId
+          AND s.terminal_id = :terminalId
+          AND t.isactive = 'T'
+        ORDER BY t.dispenser_id, t.trk_id
+    )");
+    pumpsQuery.bindValue(":terminalId", terminalId);
+
+    if (!dispensersQuery.exec() || !pumpsQuery.exec()) {
+        qCritical() << "❌ Попередній запит не вдався:" << dispensersQuery.lastError().text() << pumpsQuery.lastError().text();
+        *ok = false;
+        return {};
+    }
+
+    QJsonObject pumpsGroupedByDispenser;
+    while (pumpsQuery.next()) {
+        const QString dispenserKey = QString::number(pumpsQuery.value("dispenser_id").toInt());
+        QJsonObject pump;
+        pump["pump_id"] = pumpsQuery.value("pump_id").toInt();
+        pump["tank_id"] = pumpsQuery.value("tank_id").toInt();
+        pump["fuel_shortname"] = pumpsQuery.value("shortname").toString();
+        QJsonArray pumpsArray = pumpsGroupedByDispenser[dispenserKey].toArray();
+        pumpsArray.append(pump);
+        pumpsGroupedByDispenser[dispenserKey] = pumpsArray;
+    }
+
+    QJsonArray dispensers;
+    while (dispensersQuery.next()) {
+        QJsonObject disp;
+        const int dispenserId = dispensersQuery.value("dispenser_id").toInt();
+        disp["dispenser_id"] = dispenserId;
+        disp["protocol"] = dispensersQuery.value("name").toString();
+        disp["port"] = dispensersQuery.value("channelport").toInt();
+        disp["speed"] = dispensersQuery.value("channelspeed").toInt();
+        disp["address"] = dispensersQuery.value("netaddress").toInt();
+        if (pumpsGroupedByDispenser.contains(QString::number(dispenserId))) {
+            disp["pumps_info"] = pumpsGroupedByDispenser[QString::number(dispenserId)];
+        }
+        dispensers.append(disp);
+    }
+    *ok = true;
+    return dispensers;
+}
+
+QJsonArray singleQueryDispensers(QSqlQuery &query, int terminalId, bool *ok) {
+    query.addBindValue(terminalId);
+    query.addBindValue(terminalId);
+    *ok = query.exec();
+    if (!*ok) {
+        qCritical() << "❌ Запит ТРК з пістолетами не вдався:" << query.lastError().text();
+        return {};
+    }
+    return buildDispensersWithPumps(query).value(terminalId);
+}
+
+QHash<int, QJsonArray> batchDispensers(QSqlDatabase &db, const QList<int> &terminalIds, bool *ok) {
+    QHash<int, QJsonArray> dispensersByTerminal;
+    *ok = true;
+    for (qsizetype offset = 0; offset < terminalIds.size(); offset += kInListChunkSize) {
+        const QList<int> chunk = terminalIds.mid(offset, kInListChunkSize);
+        const qsizetype bucket = inListBucket(chunk.size());
+        QSqlQuery query(db);
+        query.prepare(dispensersWithPumpsSql(QString("IN (%1)").arg(inPlaceholders(bucket))));
+        for (int pass = 0; pass < 2; ++pass) {
+            for (qsizetype i = 0; i < bucket; ++i) {
+                query.addBindValue(chunk.at(qMin(i, chunk.size() - 1)));
+            }
+        }
+        if (!query.exec()) {
+            qCritical() << "❌ Пакетний запит ТРК з пістолетами не вдався:" << query.lastError().text();
+            *ok = false;
+            return {};
+        }
+        dispensersByTerminal.insert(buildDispensersWithPumps(query));
+    }
+    return dispensersByTerminal;
+}
+
+// 🔹 Попередній запит ТРК не мав ORDER BY, тому для порівняння впорядковуємо за dispenser_id
+QJsonArray sortedByDispenser(const QJsonArray &dispensers) {
+    QList<QJsonValue> items;
+    for (const QJsonValue &item : dispensers) {
+        items.append(item);
+    }
+    std::sort(items.begin(), items.end(), [](const QJsonValue &a, const QJsonValue &b) {
+        return a.toObject().value("dispenser_id").toInt() < b.toObject().value("dispenser_id").toInt();
+    });
+    QJsonArray sorted;
+    for (const QJsonValue &item : items) {
+        sorted.append(item);
+    }
+    return sorted;
+}
+
+template <typename Fn>
+double msPerIteration(int iterations, Fn &&fn) {
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    return double(timer.nsecsElapsed()) / 1e6 / double(iterations);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Замір вибірки ТРК з пістолетами: 2·N запитів проти одного");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"host", "Сервер Firebird", "host", "localhost"},
+        {"port", "Порт Firebird", "port", "3050"},
+        {"database", "Шлях до бази клієнта на сервері", "path"},
+        {"user", "Користувач", "user", "SYSDBA"},
+        {"password", "Пароль (відкритий текст)", "password"},
+        {"terminals", "ID АЗС через кому", "ids"},
+        {"iterations", "Кількість повторів", "count", "20"},
+    });
+    parser.process(app);
+
+    QList<int> terminalIds;
+    for (const QString &id : parser.value("terminals").split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const int terminalId = id.trimmed().toInt(&ok);
+        if (!ok) {
+            qCritical() << "❌ Некоректний ID АЗС:" << id;
+            return 1;
+        }
+        terminalIds.append(terminalId);
+    }
+    const int iterations = qMax(1, parser.value("iterations").toInt());
+    if (parser.value("database").isEmpty() || terminalIds.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QIBASE", "dispensers_bench");
+    db.setHostName(parser.value("host"));
+    db.setPort(parser.value("port").toInt());
+    db.setDatabaseName(parser.value("database"));
+    db.setUserName(parser.value("user"));
+    db.setPassword(parser.value("password"));
+    if (!db.open()) {
+        qCritical() << "❌ Не вдалося підключитися до бази:" << db.lastError().text();
+        return 1;
+    }
+
+    QSqlQuery singleQuery(db);
+    singleQuery.prepare(dispensersWithPumpsSql("= ?"));
+
+    // 🔹 Перевірка однаковості результатів (заодно прогрів кешу сторінок Firebird)
+    bool ok = true;
+    bool same = true;
+    int dispenserCount = 0;
+    const QHash<int, QJsonArray> batch = batchDispensers(db, terminalIds, &ok);
+    for (int terminalId : terminalIds) {
+        bool legacyOk = false;
+        bool singleOk = false;
+        const QJsonArray legacy = sortedByDispenser(legacyDispensers(db, terminalId, &legacyOk));
+        const QJsonArray single = singleQueryDispensers(singleQuery, terminalId, &singleOk);
+        ok = ok && legacyOk && singleOk;
+        if (legacy != single || single != batch.value(terminalId)) {
+            qCritical() << "❌ АЗС" << terminalId << ": способи повернули різні ТРК";
+            same = false;
+        }
+        dispenserCount += int(single.size());
+    }
+    if (!ok || !same) {
+        return 1;
+    }
+
+    const double legacyMs = msPerIteration(iterations, [&]() {
+        for (int terminalId : terminalIds) {
+            legacyDispensers(db, terminalId, &ok);
+        }
+    });
+    const double singleMs = msPerIteration(iterations, [&]() {
+        for (int terminalId : terminalIds) {
+            singleQueryDispensers(singleQuery, terminalId, &ok);
+        }
+    });
+    const double batchMs = msPerIteration(iterations, [&]() { batchDispensers(db, terminalIds, &ok); });
+    if (!ok) {
+        return 1;
+    }
+
+    const qsizetype terminals = terminalIds.size();
+    const qsizetype batchQueries = (terminals + kInListChunkSize - 1) / kInListChunkSize;
+    qInfo().noquote() << QString("🔹 АЗС: %1, ТРК: %2, повторів: %3").arg(terminals).arg(dispenserCount).arg(iterations);
+    qInfo().noquote() << QString("🔹 Попередній (%1 запитів): %2 мс").arg(2 * terminals).arg(legacyMs, 0, 'f', 2);
+    qInfo().noquote() << QString("🔹 Один запит на АЗС (%1 запитів): %2 мс, x%3")
+                             .arg(terminals).arg(singleMs, 0, 'f', 2).arg(legacyMs / singleMs, 0, 'f', 1);
+    qInfo().noquote() << QString("🔹 IN (...) на весь список (%1 запитів): %2 мс, x%3")
+                             .arg(batchQueries).arg(batchMs, 0, 'f', 2).arg(legacyMs / batchMs, 0, 'f', 1);
+    return 0;
+}
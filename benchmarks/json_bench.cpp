@@ -0,0 +1,125 @@
+/**
+ * @brief Замір серіалізації списків: JsonWriter проти QJsonArray + QJsonDocument (ціль `json_bench`, у ctest не входить)
+ *
+ * Рядки імітують колонки курсора QSqlQuery (QVariant) у формі відповідей /azs_list (два поля)
+ * та /reservoirs_info (вісім полів, дробові числа, NULL). Обидва способи будують однаковий
+ * документ; результат JsonWriter перед заміром розбирається QJsonDocument і порівнюється.
+ */
+#include "../Server/jsonwriter.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QVariant>
+#include <QDebug>
+
+namespace {
+
+using Row = QList<QVariant>;
+
+struct Shape {
+    const char *name;
+    const char *arrayKey;
+    QList<const char *> columns;
+    Row (*makeRow)(int i);
+};
+
+Row azsRow(int i) {
+    return {i + 1, QString("АЗС №%1 \"Центральна\"").arg(i + 1)};
+}
+
+Row reservoirRow(int i) {
+    return {1000 + i / 4, i % 4 + 1, QString("А-95"), 20000.0 + i * 0.37, 12345.67 - i * 0.11,
+            150.5 + i % 50, i % 7 == 0 ? QVariant() : QVariant(14.3 + (i % 10) * 0.1),
+            QString("2024-03-01 12:%1:00").arg(i % 60, 2, 10, QChar('0'))};
+}
+
+const Shape kShapes[] = {
+    {"/azs_list", "azs_list", {"terminal_id", "name"}, azsRow},
+    {"/reservoirs_info", "reservoirs",
+     {"terminal_id", "tank_id", "fuel_name", "capacity", "volume", "level", "temperature", "updated_at"},
+     reservoirRow},
+};
+
+// 🔹 Попередній шлях: дерево QJsonObject/QJsonArray, потім QJsonDocument::toJson
+QByteArray viaDocument(const Shape &shape, const QList<Row> &rows) {
+    QJsonArray array;
+    for (const Row &row : rows) {
+        QJsonObject object;
+        for (int c = 0; c < shape.columns.size(); ++c) {
+            object.insert(QLatin1String(shape.columns[c]), QJsonValue::fromVariant(row[c]));
+        }
+        array.append(object);
+    }
+    QJsonObject root;
+    root.insert(QLatin1String(shape.arrayKey), array);
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+// 🔹 Поточний шлях: запис одразу в буфер, як у writeList()
+QByteArray viaWriter(const Shape &shape, const QList<Row> &rows) {
+    JsonWriter writer(qsizetype(rows.size()) * 32 * shape.columns.size());
+    writer.beginObject().key(shape.arrayKey).beginArray();
+    for (const Row &row : rows) {
+        writer.beginObject();
+        for (int c = 0; c < shape.columns.size(); ++c) {
+            writer.field(shape.columns[c], row[c]);
+        }
+        writer.endObject();
+    }
+    writer.endArray().endObject();
+    return writer.take();
+}
+
+template <typename Fn>
+double nsPerIteration(qint64 iterations, Fn &&fn) {
+    QElapsedTimer timer;
+    timer.start();
+    for (qint64 i = 0; i < iterations; ++i) {
+        fn();
+    }
+    return double(timer.nsecsElapsed()) / double(iterations);
+}
+
+} // namespace
+
+int main() {
+    volatile qsizetype sink = 0;  // не дає компілятору викинути виміряний код
+    bool same = true;
+
+    for (const Shape &shape : kShapes) {
+        for (int rowCount : {10, 1000, 100000}) {
+            QList<Row> rows;
+            rows.reserve(rowCount);
+            for (int i = 0; i < rowCount; ++i) {
+                rows.append(shape.makeRow(i));
+            }
+
+            const QByteArray document = viaDocument(shape, rows);
+            const QByteArray written = viaWriter(shape, rows);
+            if (QJsonDocument::fromJson(written) != QJsonDocument::fromJson(document)) {
+                qCritical() << "❌" << shape.name << rowCount << "рядків: JsonWriter дав інший документ";
+                same = false;
+                continue;
+            }
+
+            const qint64 iterations = qMax<qint64>(3, 2000000 / (qint64(rowCount) * shape.columns.size()));
+            const double documentNs = nsPerIteration(iterations, [&]() { sink = sink + viaDocument(shape, rows).size(); });
+            const double writerNs = nsPerIteration(iterations, [&]() { sink = sink + viaWriter(shape, rows).size(); });
+            const auto mbPerSec = [](qsizetype bytes, double ns) { return double(bytes) * 1000.0 / ns; };
+
+            qInfo().noquote() << QString("🔹 %1, %2 рядків (%3 байт): QJsonDocument %4 нс/рядок (%5 МБ/с), "
+                                         "JsonWriter %6 нс/рядок (%7 МБ/с), x%8")
+                                     .arg(shape.name).arg(rowCount).arg(written.size())
+                                     .arg(documentNs / rowCount, 0, 'f', 1)
+                                     .arg(mbPerSec(document.size(), documentNs), 0, 'f', 0)
+                                     .arg(writerNs / rowCount, 0, 'f', 1)
+                                     .arg(mbPerSec(written.size(), writerNs), 0, 'f', 0)
+                                     .arg(documentNs / writerNs, 0, 'f', 1);
+        }
+    }
+    return same ? 0 : 1;
+}
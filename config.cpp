@@ -6,11 +6,13 @@
 #include <QDebug>
 #include <iostream>
 #include <QCoreApplication>
+#include <QLoggingCategory>
+#include "logwriter.h"
 
 using namespace std;
 
-// 🔹 Файл логування
-static QFile logFile;
+// 🔹 Асинхронний запис логів
+static LogWriter *logWriter = nullptr;
 LogLevel Config::currentLogLevel = Debug;  // 🔹 За замовчуванням `Debug`
 /**
  * @brief Конструктор класу Config
@@ -69,6 +71,60 @@ void Config::createDefaultConfig(const QString &configPath) {
     out << "[Server]\n";
     out << "port=8181\n";
     out << "log_level=debug\n";
+    out << "workers=8\n";
+    out << "max_queue=64\n";
+    out << "max_page_size=1000\n\n";
+
+    out << "[Logging]\n";
+    out << "queue_size=8192\n";
+    out << "max_size_mb=100\n";
+    out << "rotate_daily=true\n";
+    out << "retention=14\n";
+    out << "compress=true\n";
+    out << "format=text\n\n";
+
+    out << "[ClientPool]\n";
+    out << "keep_idle=1\n";
+    out << "max_size=4\n";
+    out << "idle_timeout_sec=300\n";
+    out << "borrow_timeout_ms=5000\n";
+    out << "validate_idle_sec=30\n";
+    out << "breaker_failures=5\n";
+    out << "breaker_open_sec=30\n\n";
+
+    out << "[Cache]\n";
+    out << "client_params_ttl_sec=3600\n\n";
+
+    out << "[Health]\n";
+    out << "probe_interval_sec=30\n\n";
+
+    out << "[ClientTimeouts]\n";
+    out << "request_timeout_ms=20000\n";
+    out << "statement_timeout_ms=15000\n\n";
+
+    out << "[Fleet]\n";
+    out << "max_concurrency=8\n";
+    out << "client_timeout_ms=10000\n";
+    out << "request_timeout_ms=60000\n\n";
+
+    out << "[Compression]\n";
+    out << "enabled=true\n";
+    out << "min_size=1024\n";
+    out << "level=6\n\n";
+
+    out << "[ResponseCache]\n";
+    out << "max_entries=1024\n";
+    out << "max_size_mb=32\n";
+    out << "terminal_info_ttl_sec=300\n";
+    out << "reservoirs_info_ttl_sec=300\n";
+    out << "azs_list_ttl_sec=60\n\n";
+
+    out << "[CacheControl]\n";
+    out << "clients=no-cache\n";
+    out << "azs_list=no-cache\n";
+    out << "reservoirs_info=no-cache\n";
+    out << "terminal_info=no-cache\n";
+    out << "pos_info=no-cache\n";
 
     file.close();
     qDebug() << "Default created`config.ini`";
@@ -199,10 +255,150 @@ int Config::getServerPort() const {
     return settings->value("Server/port", 8181).toInt();
 }
 
+int Config::getServerWorkers() const {
+    return settings->value("Server/workers", 8).toInt();
+}
+
+int Config::getServerMaxQueue() const {
+    return settings->value("Server/max_queue", 64).toInt();
+}
+
+int Config::getServerMaxPageSize() const {
+    return settings->value("Server/max_page_size", 1000).toInt();
+}
+
 QString Config::getLogLevel() const {
     return settings->value("Server/log_level", "debug").toString();
 }
 
+int Config::getLogQueueSize() const {
+    return settings->value("Logging/queue_size", 8192).toInt();
+}
+
+int Config::getLogMaxSizeMb() const {
+    return settings->value("Logging/max_size_mb", 100).toInt();
+}
+
+bool Config::getLogRotateDaily() const {
+    return settings->value("Logging/rotate_daily", true).toBool();
+}
+
+int Config::getLogRetention() const {
+    return settings->value("Logging/retention", 14).toInt();
+}
+
+bool Config::getLogCompress() const {
+    return settings->value("Logging/compress", true).toBool();
+}
+
+QString Config::getLogFormat() const {
+    return settings->value("Logging/format", "text").toString();
+}
+
+int Config::getClientPoolKeepIdle() const {
+    // 🔹 min_size — стара назва параметра; пул ніколи не відкривав підключення заздалегідь
+    return settings->value("ClientPool/keep_idle", settings->value("ClientPool/min_size", 1)).toInt();
+}
+
+int Config::getClientPoolMaxSize() const {
+    return settings->value("ClientPool/max_size", 4).toInt();
+}
+
+int Config::getClientPoolIdleTimeoutSec() const {
+    return settings->value("ClientPool/idle_timeout_sec", 300).toInt();
+}
+
+int Config::getClientPoolBorrowTimeoutMs() const {
+    return settings->value("ClientPool/borrow_timeout_ms", 5000).toInt();
+}
+
+int Config::getClientPoolValidateIdleSec() const {
+    return settings->value("ClientPool/validate_idle_sec", 30).toInt();
+}
+
+int Config::getClientPoolBreakerFailures() const {
+    return settings->value("ClientPool/breaker_failures", 5).toInt();
+}
+
+int Config::getClientPoolBreakerOpenSec() const {
+    return settings->value("ClientPool/breaker_open_sec", 30).toInt();
+}
+
+int Config::getClientParamsTtlSec() const {
+    return settings->value("Cache/client_params_ttl_sec", 3600).toInt();
+}
+
+int Config::getHealthProbeIntervalSec() const {
+    return settings->value("Health/probe_interval_sec", 30).toInt();
+}
+
+int Config::getClientRequestTimeoutMs(int clientId) const {
+    const int defaultMs = settings->value("ClientTimeouts/request_timeout_ms", 20000).toInt();
+    return settings->value(QString("ClientTimeouts/request_timeout_ms_%1").arg(clientId), defaultMs).toInt();
+}
+
+int Config::getClientStatementTimeoutMs(int clientId) const {
+    const int defaultMs = settings->value("ClientTimeouts/statement_timeout_ms", 15000).toInt();
+    return settings->value(QString("ClientTimeouts/statement_timeout_ms_%1").arg(clientId), defaultMs).toInt();
+}
+
+bool Config::getCompressionEnabled() const {
+    return settings->value("Compression/enabled", true).toBool();
+}
+
+int Config::getCompressionMinSize() const {
+    return settings->value("Compression/min_size", 1024).toInt();
+}
+
+int Config::getCompressionLevel() const {
+    return settings->value("Compression/level", 6).toInt();
+}
+
+int Config::getFleetMaxConcurrency() const {
+    return settings->value("Fleet/max_concurrency", 8).toInt();
+}
+
+int Config::getFleetClientTimeoutMs() const {
+    return settings->value("Fleet/client_timeout_ms", 10000).toInt();
+}
+
+int Config::getFleetRequestTimeoutMs() const {
+    return settings->value("Fleet/request_timeout_ms", 60000).toInt();
+}
+
+int Config::getResponseCacheMaxEntries() const {
+    return settings->value("ResponseCache/max_entries", 1024).toInt();
+}
+
+int Config::getResponseCacheMaxSizeMb() const {
+    return settings->value("ResponseCache/max_size_mb", 32).toInt();
+}
+
+/**
+ * @brief Час життя кешованих відповідей маршруту
+ * @param route Назва маршруту без `/` (наприклад, `azs_list`)
+ * @return Секунди; 0 вимикає кешування маршруту
+ */
+int Config::getResponseCacheTtlSec(const QString &route) const {
+    const int defaultTtl = (route == "azs_list") ? 60 : 300;
+    return settings->value("ResponseCache/" + route + "_ttl_sec", defaultTtl).toInt();
+}
+
+/**
+ * @brief Значення заголовка Cache-Control для маршруту
+ * @param route Назва маршруту без `/` (наприклад, `clients`)
+ * @return За замовчуванням `no-cache` (клієнт перевіряє ETag), для службових маршрутів — `no-store`
+ */
+QString Config::getCacheControl(const QString &route) const {
+    const QString defaultValue = (route == "status" || route == "stats") ? "no-store" : "no-cache";
+    const QVariant value = settings->value("CacheControl/" + route, defaultValue);
+    // 🔹 QSettings розбиває значення з комами на список ("max-age=30, must-revalidate")
+    if (value.typeId() == QMetaType::QStringList) {
+        return value.toStringList().join(", ");
+    }
+    return value.toString();
+}
+
 LogLevel Config::getLogLevelEnum() const
 {
     QString level = getLogLevel().toLower();
@@ -213,9 +409,10 @@ LogLevel Config::getLogLevelEnum() const
 }
 
 /**
- * @brief Ініціалізує логування у файл
+ * @brief Ініціалізує асинхронне логування у файл та консоль
+ * @param config Конфігурація (рівень логування, розмір черги, ротація)
  */
-void Config::initLogging(LogLevel logLevel) {
+void Config::initLogging(const Config &config) {
 
     static bool loggingInitialized = false;
     if (loggingInitialized) {
@@ -223,43 +420,63 @@ void Config::initLogging(LogLevel logLevel) {
     }
     loggingInitialized = true;
 
+    currentLogLevel = config.getLogLevelEnum();
+
+    // 🔹 Вимкнені рівні відсікаються ще в qDebug()/qInfo(), до виклику обробника
+    QStringList rules;
+    if (currentLogLevel > Debug) rules << "*.debug=false";
+    if (currentLogLevel > Info) rules << "*.info=false";
+    if (currentLogLevel > Warning) rules << "*.warning=false";
+    QLoggingCategory::setFilterRules(rules.join('\n'));
+
     QString logDirPath = QCoreApplication::applicationDirPath() + "/logs";
     QDir logDir(logDirPath);
     if (!logDir.exists()) {
         logDir.mkpath(".");
     }
 
-    QString logFilePath = logDirPath + "/palantir.log";
-    logFile.setFileName(logFilePath);
+    LogWriter::Rotation rotation;
+    rotation.maxBytes = qint64(config.getLogMaxSizeMb()) * 1024 * 1024;
+    rotation.daily = config.getLogRotateDaily();
+    rotation.retention = config.getLogRetention();
+    rotation.compress = config.getLogCompress();
 
-    if (!logFile.open(QIODevice::Append | QIODevice::Text)) {
+    QString logFilePath = logDirPath + "/palantir.log";
+    const LogWriter::Format format = config.getLogFormat().compare("json", Qt::CaseInsensitive) == 0
+                                         ? LogWriter::Json : LogWriter::Text;
+    logWriter = new LogWriter(logFilePath, config.getLogQueueSize(), rotation, format);
+    if (!logWriter->isOpen()) {
+        delete logWriter;
+        logWriter = nullptr;
         qCritical() << "❌ Не вдалося відкрити файл логів для запису!";
         return;
     }
 
-    // 🔹 Оновлюємо обробник логування
-    qInstallMessageHandler([](QtMsgType type, const QMessageLogContext &, const QString &msg) {
-        QString logEntry = QString("[%1] %2")
-        .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"))
-            .arg(msg);
-
-        QTextStream logStream(&logFile);
-        logStream << logEntry << "\n";  // 🔹 Запис у файл
-        logStream.flush();
-
-        QTextStream consoleStream(stdout);
-        consoleStream << logEntry << Qt::endl;  // 🔹 Вивід у консоль
-    });
+    // 🔹 Обробник лише ставить повідомлення в чергу; запис — у потоці LogWriter
+    qInstallMessageHandler(messageHandler);
+    qAddPostRoutine(shutdownLogging);
 
     qDebug() << "✅ Логування ініціалізовано. Файл логів:" << logFilePath;
 }
 
-void Config::messageHandler(QtMsgType type, const QMessageLogContext &, const QString &msg) {
-    QString logEntry = QString("[%1] %2\n")
-    .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"))
-        .arg(msg);
+/**
+ * @brief Записує залишок черги логів і зупиняє потік запису
+ */
+void Config::shutdownLogging() {
+    if (logWriter) {
+        logWriter->shutdown();
+    }
+}
+
+/**
+ * @brief Лічильники черги логів для `/stats`
+ */
+QJsonObject Config::loggingStats() {
+    return logWriter ? logWriter->stats() : QJsonObject();
+}
 
-    // 🔹 Фільтруємо логи за рівнем `log_level`
+void Config::messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg) {
+    // 🔹 Фільтруємо логи за рівнем `log_level` до будь-якого форматування
     bool shouldLog = false;
     switch (type) {
     case QtDebugMsg:
@@ -277,11 +494,14 @@ void Config::messageHandler(QtMsgType type, const QMessageLogContext &, const QS
         break;
     }
 
-    if (shouldLog) {
-        QTextStream logStream(&logFile);
-        logStream << logEntry;
-        logStream.flush();
-        std::cout << logEntry.toStdString();
+    if (!shouldLog) {
+        return;
     }
-}
 
+    logWriter->enqueue(type, context.category, msg);
+
+    // 🔹 Після qFatal процес завершиться — дописуємо чергу синхронно
+    if (type == QtFatalMsg) {
+        logWriter->shutdown();
+    }
+}
@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QSettings>
+#include <QJsonObject>
 
 
 enum LogLevel {
@@ -28,9 +29,54 @@ public:
     QString getDatabasePassword() const;
 
     int getServerPort() const;
+    int getServerWorkers() const;   // 🔹 Кількість робочих потоків обробників
+    int getServerMaxQueue() const;  // 🔹 Максимум запитів у черзі до відповіді 503
+    int getServerMaxPageSize() const;  // 🔹 Максимальний `limit` для /clients та /azs_list
     QString getLogLevel() const;
     LogLevel getLogLevelEnum() const;  // 🔹 Додаємо метод для переведення `log_level` у enum
-    static void initLogging(LogLevel logLevel);  // 🔹 Оновлюємо `initLogging()`, щоб підтримувати `log_level`
+    // 🔹 Логування (секція [Logging])
+    int getLogQueueSize() const;       // 🔹 Ємність черги асинхронного логування
+    int getLogMaxSizeMb() const;       // 🔹 Розмір файлу, після якого він ротується (0 — без ліміту)
+    bool getLogRotateDaily() const;    // 🔹 Ротувати файл щодня
+    int getLogRetention() const;       // 🔹 Скільки архівів зберігати
+    bool getLogCompress() const;       // 🔹 Стискати архіви в gzip
+    QString getLogFormat() const;      // 🔹 `text` або `json` (JSON-об'єкт на рядок)
+    static void initLogging(const Config &config);  // 🔹 Оновлюємо `initLogging()`, щоб підтримувати `log_level`
+    static void shutdownLogging();     // 🔹 Дописати чергу логів перед виходом
+    static QJsonObject loggingStats();  // 🔹 Лічильники черги логів
+
+    // 🔹 Пул підключень до баз клієнтів (секція [ClientPool])
+    int getClientPoolKeepIdle() const;  // 🔹 Скільки підключень на клієнта не закривати за простоєм
+    int getClientPoolMaxSize() const;
+    int getClientPoolIdleTimeoutSec() const;
+    int getClientPoolBorrowTimeoutMs() const;
+    int getClientPoolValidateIdleSec() const;
+    int getClientPoolBreakerFailures() const;  // 🔹 Невдалих підключень поспіль до розмикання запобіжника
+    int getClientPoolBreakerOpenSec() const;   // 🔹 Скільки запобіжник лишається розімкненим
+
+    int getClientParamsTtlSec() const;  // 🔹 Час життя кешу параметрів клієнтів (секція [Cache])
+    int getHealthProbeIntervalSec() const;  // 🔹 Період фонової перевірки баз для /status?deep=1 (секція [Health])
+
+    // 🔹 Тайм-аути роботи з базами клієнтів (секція [ClientTimeouts]; ключ з `_<client_id>` перекриває загальний)
+    int getClientRequestTimeoutMs(int clientId) const;    // 🔹 Сторожовий тайм-аут обробника, після якого відповідь 504
+    int getClientStatementTimeoutMs(int clientId) const;  // 🔹 STATEMENT TIMEOUT підключення (Firebird 4+)
+
+    // 🔹 Зведені маршрути /fleet/* (секція [Fleet])
+    int getFleetMaxConcurrency() const;    // 🔹 Скільки баз клієнтів опитувати одночасно
+    int getFleetClientTimeoutMs() const;   // 🔹 Скільки чекати на одну базу клієнта
+    int getFleetRequestTimeoutMs() const;  // 🔹 Скільки клієнт може чекати в черзі на опитування
+
+    // 🔹 Стиснення відповідей (секція [Compression])
+    bool getCompressionEnabled() const;
+    int getCompressionMinSize() const;  // 🔹 Менші тіла не стискаються
+    int getCompressionLevel() const;    // 🔹 Рівень zlib 1–9
+
+    // 🔹 Кеш відповідей (секція [ResponseCache])
+    int getResponseCacheMaxEntries() const;
+    int getResponseCacheMaxSizeMb() const;
+    int getResponseCacheTtlSec(const QString &route) const;
+
+    QString getCacheControl(const QString &route) const;  // 🔹 Заголовок Cache-Control маршруту (секція [CacheControl])
 private:
     QSettings *settings;  // Об'єкт для роботи з `config.ini`
     void createDefaultConfig(const QString &configPath);  // Метод створення `config.ini`, якщо його немає
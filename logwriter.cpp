@@ -0,0 +1,290 @@
+#include "logwriter.h"
+#include "Server/jsonwriter.h"
+#include "Server/compression.h"
+#include <QDateTime>
+#include <QFileInfo>
+#include <QDir>
+#include <QThreadPool>
+#include <cstdio>
+
+// 🔹 Скільки байтів накопичувати перед одним записом у файл
+static constexpr qsizetype kBatchBytes = 64 * 1024;
+// 🔹 Як довго потік запису спить, якщо його не розбудили
+static constexpr unsigned long kIdleWaitMs = 100;
+
+/**
+ * @brief Відкриває файл логів та запускає потік запису
+ * @param filePath Шлях до файлу логів (дописується в кінець)
+ * @param queueSize Ємність черги повідомлень
+ * @param rotation Налаштування ротації
+ * @param format Текстові рядки або JSON-об'єкт на рядок
+ */
+LogWriter::LogWriter(const QString &filePath, int queueSize, const Rotation &rotation, Format format)
+    : file(filePath), rotation(rotation), format(format), queue(std::size_t(qMax(64, queueSize))) {
+    if (!file.open(QIODevice::Append | QIODevice::Text)) {
+        return;
+    }
+    fileSize = file.size();
+    fileDate = QFileInfo(file).lastModified().date();
+    if (fileSize == 0 || !fileDate.isValid()) {
+        fileDate = QDate::currentDate();
+    }
+    thread = QThread::create([this]() { run(); });
+    thread->setObjectName("LogWriter");
+    thread->start(QThread::LowPriority);
+}
+
+LogWriter::~LogWriter() {
+    shutdown();
+}
+
+/**
+ * @brief Ставить повідомлення в чергу; ніколи не блокує потік, що логує
+ */
+void LogWriter::enqueue(QtMsgType type, const char *category, const QString &message) {
+    Entry entry;
+    entry.timeMs = QDateTime::currentMSecsSinceEpoch();
+    entry.type = type;
+    entry.category = category;
+    entry.message = message;
+
+    if (!queue.tryPush(std::move(entry))) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    enqueued.fetch_add(1, std::memory_order_relaxed);
+
+    // 🔹 М'ютекс потрібен лише, щоб розбудити сплячий потік запису
+    if (sleeping.load(std::memory_order_acquire) || type == QtFatalMsg) {
+        QMutexLocker locker(&wakeMutex);
+        wakeCondition.wakeOne();
+    }
+}
+
+/**
+ * @brief Зупиняє потік запису, попередньо записавши все з черги
+ */
+void LogWriter::shutdown() {
+    if (!thread) {
+        return;
+    }
+    stopping.store(true, std::memory_order_release);
+    {
+        QMutexLocker locker(&wakeMutex);
+        wakeCondition.wakeOne();
+    }
+    thread->wait();
+    delete thread;
+    thread = nullptr;
+    file.close();
+}
+
+/**
+ * @brief Лічильники черги логів для `/stats`
+ */
+QJsonObject LogWriter::stats() const {
+    QJsonObject obj;
+    const quint64 pushed = enqueued.load(std::memory_order_relaxed);
+    const quint64 done = written.load(std::memory_order_relaxed);
+    obj["queue_capacity"] = qint64(queue.capacity());
+    obj["queue_depth"] = qint64(pushed > done ? pushed - done : 0);  // 🔹 Приблизно: лічильники читаються не атомарно разом
+    obj["enqueued"] = qint64(pushed);
+    obj["dropped"] = qint64(dropped.load(std::memory_order_relaxed));
+    obj["written"] = qint64(done);
+    obj["batches"] = qint64(batches.load(std::memory_order_relaxed));
+    obj["rotations"] = qint64(rotations.load(std::memory_order_relaxed));
+    return obj;
+}
+
+/**
+ * @brief Цикл потоку запису: вибирає чергу пачками і пише їх одним викликом
+ */
+void LogWriter::run() {
+    QByteArray batch;
+    batch.reserve(kBatchBytes + 4096);
+    Entry entry;
+    quint64 count = 0;  // 🔹 Повідомлень у поточній пачці
+
+    forever {
+        while (batch.size() < kBatchBytes && queue.tryPop(entry)) {
+            appendLine(batch, entry);
+            ++count;
+        }
+
+        const quint64 lost = dropped.load(std::memory_order_relaxed);
+        if (lost != reportedDropped) {
+            Entry notice;
+            notice.timeMs = QDateTime::currentMSecsSinceEpoch();
+            notice.type = QtWarningMsg;
+            notice.message = QString("⚠️ Черга логів переповнена, втрачено повідомлень: %1").arg(lost - reportedDropped);
+            appendLine(batch, notice);
+            reportedDropped = lost;
+        }
+
+        if (!batch.isEmpty()) {
+            writeBatch(batch);
+            written.fetch_add(count, std::memory_order_relaxed);
+            batches.fetch_add(1, std::memory_order_relaxed);
+            batch.truncate(0);
+            count = 0;
+            continue;
+        }
+
+        if (stopping.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        // 🔹 Черга порожня — засинаємо; повторна перевірка після sleeping=true не дає пропустити запис
+        QMutexLocker locker(&wakeMutex);
+        sleeping.store(true, std::memory_order_seq_cst);
+        if (queue.tryPop(entry)) {
+            sleeping.store(false, std::memory_order_relaxed);
+            locker.unlock();
+            appendLine(batch, entry);
+            ++count;
+            continue;
+        }
+        if (!stopping.load(std::memory_order_acquire)) {
+            wakeCondition.wait(&wakeMutex, kIdleWaitMs);
+        }
+        sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Форматує рядок `[yyyy-MM-dd HH:mm:ss] повідомлення` (або JSON-рядок у форматі Json)
+ */
+void LogWriter::appendLine(QByteArray &batch, const Entry &entry) {
+    const qint64 second = entry.timeMs / 1000;
+    if (second != cachedSecond) {
+        cachedSecond = second;
+        const QDateTime time = QDateTime::fromMSecsSinceEpoch(second * 1000);
+        cachedStamp = time.toString("yyyy-MM-dd HH:mm:ss").toUtf8();
+        cachedIsoStamp = time.toString(Qt::ISODate).toUtf8();
+    }
+    if (format == Json) {
+        appendJsonLine(batch, entry);
+        return;
+    }
+    batch.append('[').append(cachedStamp).append("] ").append(entry.message.toUtf8()).append('\n');
+}
+
+/**
+ * @brief Форматує повідомлення як JSON-об'єкт в один рядок
+ */
+void LogWriter::appendJsonLine(QByteArray &batch, const Entry &entry) {
+    static const char *const levels[] = {"debug", "warning", "critical", "fatal", "info"};
+    const char *level = uint(entry.type) < 5 ? levels[entry.type] : "info";
+    const char *category = entry.category ? entry.category : "default";
+
+    // 🔹 Мілісекунди дописуємо до закешованої мітки секунди: 2025-03-07T12:00:00.123
+    char millis[5];
+    std::snprintf(millis, sizeof(millis), ".%03d", int(entry.timeMs % 1000));
+
+    JsonWriter writer(entry.message.size() + 128);
+    writer.beginObject()
+        .key("ts").value(QString::fromLatin1(cachedIsoStamp + millis))
+        .field("level", level)
+        .field("category", category);
+
+    // 🔹 Траси запитів уже є JSON-об'єктами — вбудовуємо їхні поля
+    const QByteArray message = entry.message.toUtf8();
+    if (qstrcmp(category, "palantir.request") == 0 && message.startsWith('{') && message.endsWith('}')
+        && message.size() > 2) {
+        writer.raw(message.mid(1, message.size() - 2));
+    } else {
+        writer.field("msg", entry.message);
+    }
+    writer.endObject();
+    batch.append(writer.take()).append('\n');
+}
+
+/**
+ * @brief Пише пачку у файл та консоль
+ */
+void LogWriter::writeBatch(const QByteArray &batch) {
+    rotateIfNeeded(batch.size());
+    fileSize += file.write(batch);
+    file.flush();
+    std::fwrite(batch.constData(), 1, size_t(batch.size()), stdout);
+    std::fflush(stdout);
+}
+
+/**
+ * @brief Ротує файл, якщо пачка не вміщається в maxBytes або змінилась дата
+ *
+ * Виконується в потоці запису; тут лише перейменування та відкриття нового файлу,
+ * стиснення архіву йде у фоновому пулі.
+ */
+void LogWriter::rotateIfNeeded(qsizetype incomingBytes) {
+    const bool bySize = rotation.maxBytes > 0 && fileSize > 0 && fileSize + incomingBytes > rotation.maxBytes;
+    const bool byDay = rotation.daily && fileSize > 0 && QDate::currentDate() != fileDate;
+    if (!bySize && !byDay) {
+        return;
+    }
+
+    const QString logPath = file.fileName();
+    const QFileInfo info(logPath);
+    const QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss");
+    QString rotatedPath = info.absolutePath() + "/" + info.completeBaseName() + "-" + stamp + ".log";
+    for (int n = 1; QFile::exists(rotatedPath) || QFile::exists(rotatedPath + ".gz"); ++n) {
+        rotatedPath = info.absolutePath() + "/" + info.completeBaseName() + "-" + stamp + "-" + QString::number(n) + ".log";
+    }
+
+    file.close();
+    if (!QFile::rename(logPath, rotatedPath)) {
+        std::fprintf(stderr, "Log rotation failed: cannot rename %s\n", qPrintable(logPath));
+        rotatedPath.clear();
+    }
+    if (!file.open(QIODevice::Append | QIODevice::Text)) {
+        std::fprintf(stderr, "Log rotation failed: cannot reopen %s\n", qPrintable(logPath));
+        return;
+    }
+    fileSize = file.size();
+    fileDate = QDate::currentDate();
+    rotations.fetch_add(1, std::memory_order_relaxed);
+
+    if (!rotatedPath.isEmpty()) {
+        const Rotation settings = rotation;
+        QThreadPool::globalInstance()->start([rotatedPath, logPath, settings]() {
+            archive(rotatedPath, logPath, settings);
+        });
+    }
+}
+
+/**
+ * @brief Стискає ротований файл у `.gz` та видаляє найстаріші архіви понад retention
+ *
+ * Файл читається блоками по 4 МБ, кожен стає окремим gzip-членом — gunzip/zcat
+ * розпаковують такі файли як один, а пам'ять не залежить від розміру логу.
+ */
+void LogWriter::archive(const QString &rotatedPath, const QString &logPath, const Rotation &rotation) {
+    static constexpr qint64 kGzipBlockBytes = 4 * 1024 * 1024;
+
+    if (rotation.compress) {
+        QFile source(rotatedPath);
+        QFile target(rotatedPath + ".gz");
+        bool ok = source.open(QIODevice::ReadOnly) && target.open(QIODevice::WriteOnly);
+        while (ok && !source.atEnd()) {
+            const QByteArray block = source.read(kGzipBlockBytes);
+            ok = !block.isEmpty() && target.write(Compression::gzip(block)) > 0;
+        }
+        source.close();
+        target.close();
+        if (ok) {
+            QFile::remove(rotatedPath);
+        } else {
+            std::fprintf(stderr, "Log compression failed: %s\n", qPrintable(rotatedPath));
+            QFile::remove(target.fileName());
+        }
+    }
+
+    // 🔹 Імена архівів містять дату й час, тож сортування за назвою — від найстарішого
+    const QFileInfo info(logPath);
+    QDir dir(info.absolutePath());
+    const QStringList archives = dir.entryList({info.completeBaseName() + "-*.log", info.completeBaseName() + "-*.log.gz"},
+                                               QDir::Files, QDir::Name);
+    for (qsizetype i = 0; i < archives.size() - qMax(0, rotation.retention); ++i) {
+        dir.remove(archives.at(i));
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <QString>
+#include <QFile>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QJsonObject>
+#include <QDate>
+#include <atomic>
+#include "mpscring.h"
+
+/**
+ * @brief Асинхронний запис логів у файл та консоль
+ *
+ * Обробник повідомлень Qt лише кладе запис у lock-free чергу (MpscRing) і повертається;
+ * форматування часу та запис на диск виконує окремий потік пачками. Якщо черга
+ * переповнена, повідомлення відкидається, а лічильник втрат потрапляє в лог
+ * при наступному записі.
+ *
+ * Потік запису також ротує файл за розміром та/або щодня: поточний файл
+ * перейменовується в `<назва>-yyyyMMdd-HHmmss.log`, а стиснення в gzip та видалення
+ * зайвих архівів виконуються у фоновому пулі потоків.
+ *
+ * У форматі Json кожен рядок — JSON-об'єкт `{"ts", "level", "category", "msg"}`;
+ * повідомлення категорії `palantir.request` (RequestTrace) вже є JSON-об'єктами,
+ * тому їхні поля вбудовуються в рядок напряму.
+ */
+class LogWriter {
+public:
+    // 🔹 Налаштування ротації (секція [Logging])
+    struct Rotation {
+        qint64 maxBytes = 0;    // ротувати, коли файл перевищить розмір; 0 — не ротувати за розміром
+        bool daily = false;     // ротувати при зміні дати
+        int retention = 7;      // скільки архівів зберігати
+        bool compress = true;   // стискати архіви в gzip
+    };
+
+    enum Format { Text, Json };
+
+    struct Entry {
+        qint64 timeMs = 0;
+        QtMsgType type = QtDebugMsg;
+        const char *category = nullptr;  // 🔹 Назва категорії Qt (статичний рядок)
+        QString message;
+    };
+
+    LogWriter(const QString &filePath, int queueSize, const Rotation &rotation, Format format = Text);
+    ~LogWriter();
+
+    bool isOpen() const { return file.isOpen(); }
+    void enqueue(QtMsgType type, const char *category, const QString &message);
+    void shutdown();  // 🔹 Дописує чергу та зупиняє потік запису
+    QJsonObject stats() const;
+
+private:
+    void run();
+    void appendLine(QByteArray &batch, const Entry &entry);
+    void appendJsonLine(QByteArray &batch, const Entry &entry);
+    void writeBatch(const QByteArray &batch);
+    void rotateIfNeeded(qsizetype incomingBytes);
+    static void archive(const QString &rotatedPath, const QString &logPath, const Rotation &rotation);
+
+    QFile file;
+    Rotation rotation;
+    Format format;
+    qint64 fileSize = 0;  // 🔹 Розмір поточного файлу (лише потік запису)
+    QDate fileDate;       // 🔹 Дата відкриття поточного файлу
+    MpscRing<Entry> queue;
+    QThread *thread = nullptr;
+
+    QMutex wakeMutex;
+    QWaitCondition wakeCondition;
+    std::atomic<bool> sleeping{false};
+    std::atomic<bool> stopping{false};
+
+    std::atomic<quint64> enqueued{0};
+    std::atomic<quint64> dropped{0};
+    std::atomic<quint64> written{0};
+    std::atomic<quint64> batches{0};
+    std::atomic<quint64> rotations{0};
+    quint64 reportedDropped = 0;  // 🔹 Скільки втрат уже записано в лог (лише потік запису)
+
+    qint64 cachedSecond = -1;     // 🔹 Секунда, для якої відформатовано cachedStamp
+    QByteArray cachedStamp;
+    QByteArray cachedIsoStamp;
+};
+
+#endif // LOGWRITER_H
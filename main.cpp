@@ -10,7 +10,7 @@ int main(int argc, char *argv[]) {
     qInfo() << "✅ Palantir запущено! Перевіряємо параметри запуску...";
 
     Config config;
-    Config::initLogging(config.getLogLevelEnum());
+    Config::initLogging(config);
 
     qInfo() << "✅ Запуск у звичайному режимі...";
     Server server(&config);
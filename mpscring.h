@@ -0,0 +1,84 @@
+#ifndef MPSCRING_H
+#define MPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/**
+ * @brief Обмежена lock-free черга: багато записувачів, один читач
+ *
+ * Кільцевий буфер зі слотами, що мають лічильник послідовності (алгоритм Д. Вюкова).
+ * Записувачі резервують слот CAS-ом на спільному лічильнику і ніколи не блокуються:
+ * якщо черга повна, tryPush() одразу повертає false. Читач — лише один потік.
+ * Ємність округлюється вгору до степеня двійки.
+ */
+template <typename T>
+class MpscRing {
+public:
+    explicit MpscRing(std::size_t minCapacity) {
+        std::size_t capacity = 2;
+        while (capacity < minCapacity) {
+            capacity *= 2;
+        }
+        mask = capacity - 1;
+        slots.reset(new Slot[capacity]);
+        for (std::size_t i = 0; i < capacity; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing &) = delete;
+    MpscRing &operator=(const MpscRing &) = delete;
+
+    std::size_t capacity() const { return mask + 1; }
+
+    bool tryPush(T &&value) {
+        std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot &slot = slots[pos & mask];
+            const std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+            const std::intptr_t diff = std::intptr_t(seq) - std::intptr_t(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = std::move(value);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // 🔹 Черга повна
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 🔹 Викликається лише з потоку-читача
+    bool tryPop(T &value) {
+        Slot &slot = slots[dequeuePos & mask];
+        const std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+        if (std::intptr_t(seq) - std::intptr_t(dequeuePos + 1) < 0) {
+            return false;  // 🔹 Черга порожня
+        }
+        value = std::move(slot.value);
+        slot.value = T();
+        slot.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+        ++dequeuePos;
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence{0};
+        T value{};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t mask = 0;
+    alignas(64) std::atomic<std::size_t> enqueuePos{0};
+    alignas(64) std::size_t dequeuePos = 0;
+};
+
+#endif // MPSCRING_H
@@ -0,0 +1,350 @@
+/**
+ * @brief Перевірка QAESEncryption векторами NIST (ctest: `aes_kat`)
+ *
+ * Вектори SP 800-38A для ECB/CBC/CFB/OFB на ключах 128/192/256 біт, доповнення ZERO/PKCS7/ISO
+ * та тест Монте-Карло за процедурою AESAVS (100 × 1000 ланцюжкових блоків) для ECB, CBC, CFB128
+ * та OFB в обидва боки — для кожної реалізації AesBackend, яку підтримує процесор.
+ * Код виходу `0` — усе пройдено, `1` — є помилки (перелік у stderr).
+ */
+#include "../Server/qaesencryption.h"
+#include "../Server/aesbackend.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QDebug>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+constexpr int BlockSize = AesBackend::BlockSize;
+
+// 🔹 Вмикає реалізацію на час перевірки й повертає попередню
+class BackendScope {
+public:
+    explicit BackendScope(AesBackend::Kind kind) : previous(AesBackend::active()) { AesBackend::setActive(kind); }
+    ~BackendScope() { AesBackend::setActive(previous); }
+
+private:
+    AesBackend::Kind previous;
+};
+
+const char *levelName(QAESEncryption::Aes level) {
+    switch (level) {
+    case QAESEncryption::AES_128: return "AES-128";
+    case QAESEncryption::AES_192: return "AES-192";
+    case QAESEncryption::AES_256: return "AES-256";
+    }
+    return "AES";
+}
+
+const char *modeName(QAESEncryption::Mode mode) {
+    switch (mode) {
+    case QAESEncryption::ECB: return "ECB";
+    case QAESEncryption::CBC: return "CBC";
+    case QAESEncryption::CFB: return "CFB";
+    case QAESEncryption::OFB: return "OFB";
+    }
+    return "?";
+}
+
+quint8 *bytes(QByteArray &data) {
+    return reinterpret_cast<quint8 *>(data.data());
+}
+
+const char *paddingName(QAESEncryption::Padding padding) {
+    switch (padding) {
+    case QAESEncryption::ZERO:  return "ZERO";
+    case QAESEncryption::PKCS7: return "PKCS7";
+    case QAESEncryption::ISO:   return "ISO";
+    }
+    return "?";
+}
+
+// NIST SP 800-38A, додаток F: спільні відкритий текст (4 блоки) та IV для всіх режимів
+const char *const nistPlain = "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                              "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710";
+const char *const nistIv = "000102030405060708090a0b0c0d0e0f";
+
+const char *nistKey(QAESEncryption::Aes level) {
+    switch (level) {
+    case QAESEncryption::AES_128: return "2b7e151628aed2a6abf7158809cf4f3c";
+    case QAESEncryption::AES_192: return "8e73b0f7da0e6452c810f32b809079e562f8ead2522c6b7b";
+    case QAESEncryption::AES_256: return "603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4";
+    }
+    return "";
+}
+
+struct KnownAnswer {
+    QAESEncryption::Aes level;
+    QAESEncryption::Mode mode;
+    const char *cipher;
+};
+
+const KnownAnswer knownAnswers[] = {
+    {QAESEncryption::AES_128, QAESEncryption::ECB, "3ad77bb40d7a3660a89ecaf32466ef97f5d3d58503b9699de785895a96fdbaaf"
+                                                   "43b1cd7f598ece23881b00e3ed0306887b0c785e27e8ad3f8223207104725dd4"},
+    {QAESEncryption::AES_192, QAESEncryption::ECB, "bd334f1d6e45f25ff712a214571fa5cc974104846d0ad3ad7734ecb3ecee4eef"
+                                                   "ef7afd2270e2e60adce0ba2face6444e9a4b41ba738d6c72fb16691603c18e0e"},
+    {QAESEncryption::AES_256, QAESEncryption::ECB, "f3eed1bdb5d2a03c064b5a7e3db181f8591ccb10d410ed26dc5ba74a31362870"
+                                                   "b6ed21b99ca6f4f9f153e7b1beafed1d23304b7a39f9f3ff067d8d8f9e24ecc7"},
+    {QAESEncryption::AES_128, QAESEncryption::CBC, "7649abac8119b246cee98e9b12e9197d5086cb9b507219ee95db113a917678b2"
+                                                   "73bed6b8e3c1743b7116e69e222295163ff1caa1681fac09120eca307586e1a7"},
+    {QAESEncryption::AES_192, QAESEncryption::CBC, "4f021db243bc633d7178183a9fa071e8b4d9ada9ad7dedf4e5e738763f69145a"
+                                                   "571b242012fb7ae07fa9baac3df102e008b0e27988598881d920a9e64f5615cd"},
+    {QAESEncryption::AES_256, QAESEncryption::CBC, "f58c4c04d6e5f1ba779eabfb5f7bfbd69cfc4e967edb808d679f777bc6702c7d"
+                                                   "39f23369a9d9bacfa530e26304231461b2eb05e2c39be9fcda6c19078c6a9d1b"},
+    {QAESEncryption::AES_128, QAESEncryption::CFB, "3b3fd92eb72dad20333449f8e83cfb4ac8a64537a0b3a93fcde3cdad9f1ce58b"
+                                                   "26751f67a3cbb140b1808cf187a4f4dfc04b05357c5d1c0eeac4c66f9ff7f2e6"},
+    {QAESEncryption::AES_192, QAESEncryption::CFB, "cdc80d6fddf18cab34c25909c99a417467ce7f7f81173621961a2b70171d3d7a"
+                                                   "2e1e8a1dd59b88b1c8e60fed1efac4c9c05f9f9ca9834fa042ae8fba584b09ff"},
+    {QAESEncryption::AES_256, QAESEncryption::CFB, "dc7e84bfda79164b7ecd8486985d386039ffed143b28b1c832113c6331e5407b"
+                                                   "df10132415e54b92a13ed0a8267ae2f975a385741ab9cef82031623d55b1e471"},
+    {QAESEncryption::AES_128, QAESEncryption::OFB, "3b3fd92eb72dad20333449f8e83cfb4a7789508d16918f03f53c52dac54ed825"
+                                                   "9740051e9c5fecf64344f7a82260edcc304c6528f659c77866a510d9c1d6ae5e"},
+    {QAESEncryption::AES_192, QAESEncryption::OFB, "cdc80d6fddf18cab34c25909c99a4174fcc28b8d4c63837c09e81700c1100401"
+                                                   "8d9a9aeac0f6596f559c6d4daf59a5f26d9f200857ca6c3e9cac524bd9acc92a"},
+    {QAESEncryption::AES_256, QAESEncryption::OFB, "dc7e84bfda79164b7ecd8486985d38604febdc6740d20b3ac88f6ad82a4fb08d"
+                                                   "71ab47a086e86eedf39d1c5bba97c4080126141d67f37be8538f5a8be740e484"},
+};
+
+// Тест Монте-Карло (AESAVS, 6.4): початкові ключ, IV та блок — із SP 800-38A, очікуваний
+// результат останнього з 100 зовнішніх кроків обчислено незалежно (OpenSSL)
+struct MonteCarlo {
+    QAESEncryption::Aes level;
+    QAESEncryption::Mode mode;
+    bool encrypt;
+    const char *result;
+};
+
+const MonteCarlo monteCarloVectors[] = {
+    {QAESEncryption::AES_128, QAESEncryption::ECB, true,  "21225aeb1207dbbe7a8fed5b923a8b8d"},
+    {QAESEncryption::AES_128, QAESEncryption::ECB, false, "822997ab0d9ed6f7dc0740004fc9bb06"},
+    {QAESEncryption::AES_128, QAESEncryption::CBC, true,  "0ffca9f3c231e8ad2b95ed14e7e3dfc8"},
+    {QAESEncryption::AES_128, QAESEncryption::CBC, false, "dfd27db2506302494ef399cf70c77e9a"},
+    {QAESEncryption::AES_192, QAESEncryption::ECB, true,  "45734638d9ffaf17966862550c29b40f"},
+    {QAESEncryption::AES_192, QAESEncryption::ECB, false, "f56b1811628aec825764d0849d29fa6e"},
+    {QAESEncryption::AES_192, QAESEncryption::CBC, true,  "5a914a2cd86e938a10437011f494b7f8"},
+    {QAESEncryption::AES_192, QAESEncryption::CBC, false, "10cdcd9334731b1b1de24d8bd23340f1"},
+    {QAESEncryption::AES_256, QAESEncryption::ECB, true,  "9954a28f2cf620ff7ebc03e38c6c9d80"},
+    {QAESEncryption::AES_256, QAESEncryption::ECB, false, "c3f82baeb1eef4616fe18e0ed4e3e71b"},
+    {QAESEncryption::AES_256, QAESEncryption::CBC, true,  "e6e601b8091dd65d27d02804db1622bb"},
+    {QAESEncryption::AES_256, QAESEncryption::CBC, false, "9ae81fd083747e50655634ddcfceb24a"},
+    {QAESEncryption::AES_128, QAESEncryption::CFB, true,  "380386942cb6e1fe7f6eb4d2cfa6f936"},
+    {QAESEncryption::AES_128, QAESEncryption::CFB, false, "e878d69af60b826259072f3757d2a07c"},
+    {QAESEncryption::AES_128, QAESEncryption::OFB, true,  "0ffb52da28a9cc413bfd62341aabe2da"},
+    {QAESEncryption::AES_128, QAESEncryption::OFB, false, "0ffb52da28a9cc413bfd62341aabe2da"},
+    {QAESEncryption::AES_192, QAESEncryption::CFB, true,  "8e5baaab0940243fd7a453475192bda0"},
+    {QAESEncryption::AES_192, QAESEncryption::CFB, false, "b1036a4df3786a684741b9c19f306307"},
+    {QAESEncryption::AES_192, QAESEncryption::OFB, true,  "a7620a3a851b3b1520e743b71a12780b"},
+    {QAESEncryption::AES_192, QAESEncryption::OFB, false, "a7620a3a851b3b1520e743b71a12780b"},
+    {QAESEncryption::AES_256, QAESEncryption::CFB, true,  "8333337c0562aadbfec60f5cf2724051"},
+    {QAESEncryption::AES_256, QAESEncryption::CFB, false, "ef2c7988286119eb8b06a08ced9f0668"},
+    {QAESEncryption::AES_256, QAESEncryption::OFB, true,  "7c1785ae07310933ff10d09645226bc7"},
+    {QAESEncryption::AES_256, QAESEncryption::OFB, false, "7c1785ae07310933ff10d09645226bc7"},
+};
+
+/**
+ * @brief Один тест Монте-Карло: 100 зовнішніх кроків по 1000 ланцюжкових блоків зі зміною ключа
+ *
+ * ECB/CBC: кожен блок проходить через encode()/decode() окремо, а ланцюжок CBC ведеться тут.
+ * CFB128/OFB: 1000 блоків одного зовнішнього кроку — один потік через encryptBlocks()/decryptBlocks(),
+ * стан якого між викликами веде сама QAESEncryption.
+ * ECB: наступний вхід — попередній вихід. CBC-шифрування, CFB128 та OFB в обидва боки: вхід j+1 —
+ * вихід j-1 (для j = 0 — IV); CBC-розшифрування: вхід j+1 — вихід j. Новий ключ — XOR з останніми
+ * байтами (за довжиною ключа) двох останніх виходів, записаних поспіль.
+ */
+QByteArray monteCarloRun(const MonteCarlo &vector) {
+    QAESEncryption aes(vector.level, vector.mode, QAESEncryption::ZERO);
+    QByteArray key = QByteArray::fromHex(nistKey(vector.level));
+    QByteArray iv = QByteArray::fromHex(nistIv);
+    QByteArray text = QByteArray::fromHex(nistPlain).left(BlockSize);
+    const int extra = int(key.size()) - BlockSize;
+    const bool streamMode = vector.mode == QAESEncryption::CFB || vector.mode == QAESEncryption::OFB;
+
+    QByteArray last;
+    QByteArray beforeLast;
+    for (int i = 0; i < 100; ++i) {
+        QByteArray chain = iv;
+        QByteArray in = text;
+        quint8 schedule[AesBackend::MaxScheduleSize];
+        if (streamMode) {
+            aes.expandKey(bytes(key), schedule, true);
+        }
+        for (int j = 0; j < 1000; ++j) {
+            beforeLast = last;
+            if (streamMode) {
+                last = QByteArray(BlockSize, Qt::Uninitialized);
+                const quint8 *input = reinterpret_cast<const quint8 *>(in.constData());
+                if (vector.encrypt) {
+                    aes.encryptBlocks(schedule, bytes(chain), input, bytes(last), BlockSize);
+                } else {
+                    aes.decryptBlocks(schedule, bytes(chain), input, bytes(last), BlockSize);
+                }
+            } else {
+                last = vector.encrypt ? aes.encode(in, key, chain) : aes.decode(in, key, chain);
+            }
+
+            if (streamMode) {
+                in = j == 0 ? iv : beforeLast;
+            } else if (vector.mode == QAESEncryption::CBC && vector.encrypt) {
+                in = j == 0 ? iv : beforeLast;
+                chain = last;
+            } else if (vector.mode == QAESEncryption::CBC) {
+                chain = in;
+                in = last;
+            } else {
+                in = last;
+            }
+        }
+
+        const QByteArray tail = beforeLast.right(qMax(0, extra)) + last;
+        for (int k = 0; k < key.size(); ++k) {
+            key[k] = char(quint8(key[k]) ^ quint8(tail[k]));
+        }
+        if (vector.mode == QAESEncryption::ECB) {
+            text = last;
+        } else {
+            iv = last;
+            text = beforeLast;
+        }
+    }
+    return last;
+}
+
+// 🔹 Доповнення, записане вручну, щоб перевіряти QAESEncryption незалежно від нього самого
+QByteArray expectedPadding(QAESEncryption::Padding padding, qsizetype size) {
+    int count = int((BlockSize - size % BlockSize) % BlockSize);
+    switch (padding) {
+    case QAESEncryption::PKCS7:
+        if (count == 0) {
+            count = BlockSize;
+        }
+        return QByteArray(count, char(count));
+    case QAESEncryption::ISO:
+        return count > 0 ? QByteArray(count - 1, 0x00).prepend('\x80') : QByteArray();
+    default:
+        return QByteArray(count, 0x00);
+    }
+}
+
+/**
+ * @brief Вектори SP 800-38A через encode/decode та блоковий API частинами, доповнення ZERO/PKCS7/ISO
+ */
+bool knownAnswer(QStringList &failures) {
+    bool ok = true;
+
+    const QByteArray plain = QByteArray::fromHex(nistPlain);
+    const QByteArray iv = QByteArray::fromHex(nistIv);
+    for (const KnownAnswer &vector : knownAnswers) {
+        const QString name = QString("%1-%2").arg(levelName(vector.level), modeName(vector.mode));
+        const QByteArray key = QByteArray::fromHex(nistKey(vector.level));
+        const QByteArray cipher = QByteArray::fromHex(vector.cipher);
+        QAESEncryption aes(vector.level, vector.mode, QAESEncryption::ZERO);
+
+        if (aes.encode(plain, key, iv) != cipher) {
+            failures.append(name + " encrypt");
+            ok = false;
+        }
+        if (aes.decode(cipher, key, iv) != plain) {
+            failures.append(name + " decrypt");
+            ok = false;
+        }
+
+        // 🔹 Дві половини з IV, який переносить блоковий API, мають дати той самий результат
+        const bool forwardOnly = vector.mode == QAESEncryption::CFB || vector.mode == QAESEncryption::OFB;
+        const qsizetype half = plain.size() / 2;
+        const quint8 *rawKey = reinterpret_cast<const quint8 *>(key.constData());
+        quint8 schedule[AesBackend::MaxScheduleSize];
+        quint8 chain[BlockSize];
+
+        QByteArray streamed(plain);
+        aes.expandKey(rawKey, schedule, true);
+        std::memcpy(chain, iv.constData(), sizeof(chain));
+        aes.encryptBlocks(schedule, chain, bytes(streamed), bytes(streamed), half);
+        aes.encryptBlocks(schedule, chain, bytes(streamed) + half, bytes(streamed) + half, plain.size() - half);
+        if (streamed != cipher) {
+            failures.append(name + " encrypt in parts");
+            ok = false;
+        }
+
+        aes.expandKey(rawKey, schedule, forwardOnly);
+        std::memcpy(chain, iv.constData(), sizeof(chain));
+        aes.decryptBlocks(schedule, chain, bytes(streamed), bytes(streamed), half);
+        aes.decryptBlocks(schedule, chain, bytes(streamed) + half, bytes(streamed) + half, plain.size() - half);
+        if (streamed != plain) {
+            failures.append(name + " decrypt in parts");
+            ok = false;
+        }
+    }
+
+    const QAESEncryption::Mode modes[] = {QAESEncryption::ECB, QAESEncryption::CBC, QAESEncryption::CFB, QAESEncryption::OFB};
+    const QAESEncryption::Aes levels[] = {QAESEncryption::AES_128, QAESEncryption::AES_192, QAESEncryption::AES_256};
+    const QAESEncryption::Padding paddings[] = {QAESEncryption::ZERO, QAESEncryption::PKCS7, QAESEncryption::ISO};
+    const int sizes[] = {0, 1, 15, 16, 17, 31, 32, 33};
+    for (QAESEncryption::Aes level : levels) {
+        const QByteArray key = QByteArray::fromHex(nistKey(level));
+        for (QAESEncryption::Mode mode : modes) {
+            QAESEncryption unpadded(level, mode, QAESEncryption::ZERO);
+            for (QAESEncryption::Padding padding : paddings) {
+                QAESEncryption aes(level, mode, padding);
+                for (int size : sizes) {
+                    QByteArray message(size, Qt::Uninitialized);
+                    for (int i = 0; i < size; ++i) {
+                        message[i] = char('a' + i % 26);  // без нулів і 0x80, тож доповнення знімається однозначно
+                    }
+
+                    const QByteArray encoded = aes.encode(message, key, iv);
+                    if (encoded != unpadded.encode(message + expectedPadding(padding, size), key, iv)
+                        || aes.removePadding(aes.decode(encoded, key, iv)) != message) {
+                        failures.append(QString("%1-%2 %3 padding, %4 bytes")
+                                            .arg(levelName(level), modeName(mode), paddingName(padding)).arg(size));
+                        ok = false;
+                    }
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+bool monteCarlo(QStringList &failures) {
+    bool ok = true;
+    for (const MonteCarlo &vector : monteCarloVectors) {
+        if (monteCarloRun(vector) != QByteArray::fromHex(vector.result)) {
+            failures.append(QString("%1-%2 MCT %3").arg(levelName(vector.level), modeName(vector.mode),
+                                                        vector.encrypt ? "encrypt" : "decrypt"));
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    bool ok = true;
+    for (AesBackend::Kind kind : {AesBackend::Portable, AesBackend::AesNi}) {
+        if (!AesBackend::isSupported(kind)) {
+            qInfo() << "🔸" << AesBackend::name(kind) << ": не підтримується цим процесором, пропускаємо";
+            continue;
+        }
+        BackendScope scope(kind);
+
+        QStringList failures;
+        QElapsedTimer timer;
+        timer.start();
+        const bool kat = knownAnswer(failures);
+        const bool mct = monteCarlo(failures);
+        if (kat && mct) {
+            qInfo() << "✅" << AesBackend::name(kind) << ": KAT та MCT пройдено за" << timer.elapsed() << "мс";
+            continue;
+        }
+
+        for (const QString &failure : std::as_const(failures)) {
+            qCritical() << "❌" << AesBackend::name(kind) << ":" << failure;
+        }
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}